@@ -0,0 +1,129 @@
+/* microbench.c - Timing every engine through libgol
+ *
+ * Built with make microbench, against libgol and nothing else of the
+ * program, so it only ever sees what gol.h has. Every engine gets the same
+ * random soup and steps it, reads every row back out, and saves and loads
+ * it again, each one timed on its own. The rows after loading have to be
+ * the ones from before saving, and the population at the end has to be the
+ * same for every engine (except hashlife and sparse, once something leaves
+ * the grid).
+ *
+ *   microbench [size] [gens] [threads] [seed]
+ *
+ * runs a size x size soup (default 1024) for gens generations (default
+ * 200) on threads threads (default 1, 0 for one per core).
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "gol.h"
+
+#define MICROBENCH_FILE "microbench.gol"
+
+static const char* const engines[] = { "byte", "bit", "tile", "hashlife", "sparse" };
+
+// FNV-1a over every row, which also touches every byte so reading them
+// can't be skipped
+static uint64_t read_rows(gol* g, uint8_t* row)
+{
+    uint64_t hash = 14695981039346656037ULL;
+
+    for (int y = 0; y < gol_height(g); y++)
+    {
+        gol_get_row(g, y, row);
+
+        for (int x = 0; x < gol_width(g); x++)
+            hash = (hash ^ row[x]) * 1099511628211ULL;
+    }
+
+    return hash;
+}
+
+static double now(void)
+{
+    struct timespec t;
+    timespec_get(&t, TIME_UTC);
+    return t.tv_sec + t.tv_nsec / 1e9;
+}
+
+int main(int argc, char** argv)
+{
+    int size = argc > 1 ? atoi(argv[1]) : 1024;
+    long long gens = argc > 2 ? atoll(argv[2]) : 200;
+    int threads = argc > 3 ? atoi(argv[3]) : 1;
+    unsigned long long seed = argc > 4 ? strtoull(argv[4], NULL, 10) : 1;
+
+    if (size <= 0 || gens <= 0 || threads < 0)
+    {
+        printf("Usage: %s [size] [gens] [threads] [seed]\n", argv[0]);
+        return 1;
+    }
+
+    uint8_t* row = malloc(size);
+    if (!row)
+        return 1;
+
+    printf("%dx%d soup from seed %llu, %lld generations, %d threads, API version %d\n\n", size, size, seed, gens, threads, GOL_API_VERSION);
+    printf("%-10s %14s %16s %12s %12s %12s %12s\n", "engine", "ns/gen", "cell updates/s", "rows ms", "save ms", "load ms", "population");
+
+    int result = 0;
+
+    for (size_t i = 0; i < sizeof(engines) / sizeof(engines[0]); i++)
+    {
+        gol* g = gol_create(engines[i], size, size);
+
+        if (!g)
+        {
+            printf("%-10s unable to create a %dx%d grid\n", engines[i], size, size);
+            continue;
+        }
+
+        if (threads != 1 && !gol_set_threads(g, threads))
+            printf("%-10s unable to start %d threads, stepping on one\n", engines[i], threads);
+
+        gol_soup(g, seed, 0.35);
+
+        double start = now();
+        int ok = gol_step(g, (uint64_t)gens);
+        double stepped = now();
+
+        if (!ok)
+        {
+            printf("%-10s ran out of memory at generation %llu\n", gol_engine(g), (unsigned long long)gol_generation(g));
+            gol_destroy(g);
+            result = 1;
+            continue;
+        }
+
+        uint64_t rows = read_rows(g, row);
+        double read = now();
+
+        int saved = gol_save(g, MICROBENCH_FILE);
+        double written = now();
+
+        gol_clear(g);
+        int loaded = saved && gol_load(g, MICROBENCH_FILE);
+        double done = now();
+
+        double seconds = stepped - start;
+
+        printf("%-10s %14.0f %16.3g %12.3f %12.3f %12.3f %12llu\n", gol_engine(g),
+            seconds * 1e9 / gens, seconds > 0 ? (double)size * size * gens / seconds : 0,
+            (read - stepped) * 1000, (written - read) * 1000, (done - written) * 1000,
+            (unsigned long long)gol_population(g));
+
+        if (!loaded || read_rows(g, row) != rows)
+        {
+            printf("%-10s the grid didn't come back the same after saving and loading it!\n", gol_engine(g));
+            result = 1;
+        }
+
+        gol_destroy(g);
+    }
+
+    remove(MICROBENCH_FILE);
+    free(row);
+
+    return result;
+}
@@ -0,0 +1,49 @@
+/* aligned.c - Cache line aligned allocations
+*/
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "aligned.h"
+
+#ifdef _WIN32
+#include <malloc.h>
+#endif
+
+void* aligned_calloc(size_t count, size_t size)
+{
+    if (size != 0 && count > SIZE_MAX / size)
+        return NULL;
+
+    size_t bytes = count * size;
+    if (bytes > SIZE_MAX - CACHE_LINE_SIZE)
+        return NULL;
+
+    // Round up so the allocation always ends on a cache line too
+    bytes = (bytes + CACHE_LINE_SIZE - 1) & ~(size_t)(CACHE_LINE_SIZE - 1);
+    if (bytes == 0)
+        bytes = CACHE_LINE_SIZE;
+
+    void* ptr;
+
+#ifdef _WIN32
+    ptr = _aligned_malloc(bytes, CACHE_LINE_SIZE);
+#else
+    if (posix_memalign(&ptr, CACHE_LINE_SIZE, bytes) != 0)
+        ptr = NULL;
+#endif
+
+    if (ptr)
+        memset(ptr, 0, bytes);
+
+    return ptr;
+}
+
+void aligned_free(void* ptr)
+{
+#ifdef _WIN32
+    _aligned_free(ptr);
+#else
+    free(ptr);
+#endif
+}
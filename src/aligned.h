@@ -0,0 +1,22 @@
+/* aligned.h - Cache line aligned allocations
+ *
+ * Grids can get really big, so they are allocated on the heap on cache line
+ * boundaries. That way rows never share a cache line with some unrelated
+ * allocation, and the engines can count on their data starting on one.
+*/
+
+#ifndef ALIGNED_H
+#define ALIGNED_H
+
+#include <stddef.h>
+
+#define CACHE_LINE_SIZE 64
+
+// Allocate count * size zeroed bytes aligned to CACHE_LINE_SIZE.
+// Returns NULL if the allocation fails or the size overflows.
+void* aligned_calloc(size_t count, size_t size);
+
+// Free memory from aligned_calloc, NULL is fine
+void aligned_free(void* ptr);
+
+#endif
@@ -0,0 +1,154 @@
+/* bench.c - Benchmarks
+*/
+
+#include <SDL2/SDL.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "bench.h"
+#include "engine.h"
+#include "soup.h"
+#include "bytekernel.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+typedef struct
+{
+    int width;
+    int height;
+    double density;
+    long long gens;
+
+    // Hashlife has to remember every different 4x4 block it ever sees, which
+    // runs into gigabytes on big dense soups, and the sparse engine spends a
+    // hash table slot on every live cell, so they skip those
+    int unbounded;
+} bench_case;
+
+// Bigger grids get fewer generations so every case takes about as long
+static const bench_case cases[] =
+{
+    { 256, 144, 0.35, 2000, 1 },
+    { 1024, 1024, 0.35, 200, 1 },
+    { 4096, 4096, 0.35, 20, 0 },
+    { 4096, 4096, 0.01, 200, 1 },
+};
+
+typedef struct
+{
+    const char* engine;
+    int threaded;
+} bench_engine;
+
+static const bench_engine engines[] =
+{
+    { "byte", 0 },
+    { "byte", 1 },
+    { "bit", 0 },
+    { "bit", 1 },
+    { "tile", 0 },
+    { "tile", 1 },
+    { "hashlife", 0 },
+    { "sparse", 0 },
+    { "gpu", 0 },
+};
+
+// Most memory the whole program has used at once, in bytes
+static size_t peak_memory(void)
+{
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters;
+
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+        return counters.PeakWorkingSetSize;
+
+    return 0;
+#else
+    struct rusage usage;
+
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+        return 0;
+
+#ifdef __APPLE__
+    return (size_t)usage.ru_maxrss;
+#else
+    return (size_t)usage.ru_maxrss * 1024;
+#endif
+#endif
+}
+
+int bench_run(const options* opts)
+{
+    workers* pool = workers_create(opts->threads > 1 ? opts->threads : 0);
+
+    if (!pool)
+    {
+        printf("Unable to start worker threads!\n");
+        return -1;
+    }
+
+    const char* kernel;
+    byte_kernel_pick(&rule_life, &kernel);
+
+    printf("Seed %llu, %d threads for the threaded runs, %s byte kernel\n\n", (unsigned long long)opts->seed, workers_count(pool), kernel);
+    printf("%-10s %-8s %-11s %-8s %-6s %14s %16s %10s %12s\n", "engine", "threads", "grid", "density", "gens", "ns/gen", "cell updates/s", "memory", "population");
+
+    for (size_t c = 0; c < SDL_arraysize(cases); c++)
+    {
+        const bench_case* bc = &cases[c];
+
+        for (size_t i = 0; i < SDL_arraysize(engines); i++)
+        {
+            const bench_engine* be = &engines[i];
+
+            if (!bc->unbounded && (strcmp(be->engine, "hashlife") == 0 || strcmp(be->engine, "sparse") == 0))
+                continue;
+
+            engine* e = engine_create(be->engine, bc->width, bc->height);
+
+            if (!e)
+            {
+                printf("%-10s unable to create a %dx%d grid\n", be->engine, bc->width, bc->height);
+                continue;
+            }
+
+            if (be->threaded)
+                e->pool = pool;
+
+            soup_fill(e, opts->seed, bc->density, 0, 0, bc->width, bc->height);
+
+            Uint64 start = SDL_GetPerformanceCounter();
+            engine_advance(e, (uint64_t)bc->gens);
+            Uint64 end = SDL_GetPerformanceCounter();
+
+            double seconds = (double)(end - start) / SDL_GetPerformanceFrequency();
+            double cells = (double)bc->width * bc->height * bc->gens;
+            char grid[32];
+            char density[16];
+
+            snprintf(grid, sizeof(grid), "%dx%d", bc->width, bc->height);
+            snprintf(density, sizeof(density), "%g%%", bc->density * 100);
+
+            printf("%-10s %-8d %-11s %-8s %-6lld %14.0f %16.3g %9zuK %12lld\n",
+                be->engine, be->threaded ? workers_count(pool) : 1, grid, density, bc->gens,
+                seconds * 1e9 / bc->gens, seconds > 0 ? cells / seconds : 0,
+                (e->memory(e) + 1023) / 1024, (long long)engine_population(e));
+
+            fflush(stdout);
+            e->destroy(e);
+        }
+    }
+
+    // Hashlife's and sparse's population is only the same as the others as
+    // long as nothing reaches the edge, cells outside the grid keep going
+    // there
+    printf("\nPeak memory %.1fM\n", peak_memory() / (1024.0 * 1024.0));
+
+    workers_destroy(pool);
+    return 0;
+}
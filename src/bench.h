@@ -0,0 +1,16 @@
+/* bench.h - Benchmarks
+ *
+ * Runs every engine over the same set of random soups and prints how fast
+ * each one went, so it's easy to tell if a change made things slower. The
+ * soups come from a fixed seed, so runs can be compared with each other.
+*/
+
+#ifndef BENCH_H
+#define BENCH_H
+
+#include "options.h"
+
+// Run all the benchmarks, returns the exit code for main()
+int bench_run(const options* opts);
+
+#endif
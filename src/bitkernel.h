@@ -0,0 +1,129 @@
+/* bitkernel.h - Bit-packed generation kernel
+ *
+ * The math for stepping one 64 bit word of cells, shared by the engines that
+ * store their grid bit-packed. Cell x of a row lives in bit (x % 64) of word
+ * (x / 64). Instead of counting neighbors one cell at a time, the neighbors
+ * are lined up by shifting the rows above, below and the row itself one bit
+ * left and right, and then added up with bitwise full adders. Each bit of
+ * the results is one cell, so a few dozen operations do 64 cells.
+ *
+ * Every row needs an extra word on both sides of it (i = -1 and i = words)
+ * holding whatever is past the edge, so the shifts never have to check if
+ * they're at the end of the row.
+*/
+
+#ifndef BITKERNEL_H
+#define BITKERNEL_H
+
+#include <stdint.h>
+#include "rule.h"
+
+// Neighbors on the left, lined up with the cells they belong to
+static inline uint64_t bit_west(const uint64_t* row, int i)
+{
+    return (row[i] << 1) | (row[i - 1] >> 63);
+}
+
+// Neighbors on the right, lined up with the cells they belong to
+static inline uint64_t bit_east(const uint64_t* row, int i)
+{
+    return (row[i] >> 1) | (row[i + 1] << 63);
+}
+
+// How many cells in the word are alive
+static inline int bit_count(uint64_t word)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_popcountll(word);
+#else
+    word = word - ((word >> 1) & 0x5555555555555555ull);
+    word = (word & 0x3333333333333333ull) + ((word >> 2) & 0x3333333333333333ull);
+    word = (word + (word >> 4)) & 0x0F0F0F0F0F0F0F0Full;
+    return (int)((word * 0x0101010101010101ull) >> 56);
+#endif
+}
+
+// How many cells in [x0, x1) of a row are alive
+static inline uint32_t bit_count_range(const uint64_t* row, int x0, int x1)
+{
+    int first = x0 >> 6;
+    int last = (x1 - 1) >> 6;
+    uint32_t count = 0;
+
+    for (int i = first; i <= last; i++)
+    {
+        uint64_t word = row[i];
+
+        if (i == first)
+            word &= UINT64_MAX << (x0 & 63);
+        if (i == last && (x1 & 63))
+            word &= ((uint64_t)1 << (x1 & 63)) - 1;
+
+        count += bit_count(word);
+    }
+
+    return count;
+}
+
+// Next generation of word i of row, given the rows above and below it.
+// Pass birth and survive as constants (see rule.h) and only the counts the
+// rule uses get worked out.
+RULE_INLINE uint64_t bit_step_word(const uint64_t* above, const uint64_t* row, const uint64_t* below, int i, unsigned birth, unsigned survive)
+{
+    uint64_t al = bit_west(above, i), ac = above[i], ar = bit_east(above, i);
+    uint64_t ml = bit_west(row, i), mr = bit_east(row, i);
+    uint64_t bl = bit_west(below, i), bc = below[i], br = bit_east(below, i);
+
+    // Add up each row of three into a 2 bit number (a1 a0, c1 c0).
+    // The middle row leaves out the cell itself so it only has two.
+    uint64_t a0 = al ^ ac ^ ar;
+    uint64_t a1 = (al & ac) | (ar & (al ^ ac));
+    uint64_t m0 = ml ^ mr;
+    uint64_t m1 = ml & mr;
+    uint64_t c0 = bl ^ bc ^ br;
+    uint64_t c1 = (bl & bc) | (br & (bl ^ bc));
+
+    // Add the ones column, carrying into the twos column
+    uint64_t t = a0 ^ m0;
+    uint64_t s0 = t ^ c0;
+    uint64_t carry = (a0 & m0) | (c0 & t);
+
+    // Add the twos column. Life only needs to know if it is odd, and if
+    // anything carries into the fours column (4 or more neighbors)
+    uint64_t u = a1 ^ m1;
+    uint64_t v = c1 ^ carry;
+    uint64_t s1 = u ^ v;
+    uint64_t fours = (a1 & m1) | (c1 & carry) | (u & v);
+
+    // 2 neighbors keeps a live cell alive, 3 neighbors always makes one
+    if (birth == RULE_LIFE_BIRTH && survive == RULE_LIFE_SURVIVE)
+        return s1 & ~fours & (s0 | row[i]);
+
+    // Other rules need the whole count. u & v can only be set when neither
+    // of the other two carries is, so at most two of them carry at once,
+    // and only all 8 neighbors being alive does that.
+    uint64_t s2 = (a1 & m1) ^ (c1 & carry) ^ (u & v);
+    uint64_t s3 = a1 & m1 & c1 & carry;
+
+    uint64_t born = 0;
+    uint64_t kept = 0;
+
+    RULE_UNROLL
+    for (int n = 0; n <= 8; n++)
+    {
+        if (!((birth | survive) >> n & 1))
+            continue;
+
+        // Every cell with exactly n neighbors
+        uint64_t count = (n & 1 ? s0 : ~s0) & (n & 2 ? s1 : ~s1) & (n & 4 ? s2 : ~s2) & (n & 8 ? s3 : ~s3);
+
+        if (birth >> n & 1)
+            born |= count;
+        if (survive >> n & 1)
+            kept |= count;
+    }
+
+    return (born & ~row[i]) | (kept & row[i]);
+}
+
+#endif
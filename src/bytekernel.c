@@ -0,0 +1,380 @@
+/* bytekernel.c - Vectorized byte grid kernel
+ *
+ * Every kernel is built no matter what flags the compiler was given, and the
+ * CPU gets asked at runtime which ones it can actually run.
+ *
+ * Once the neighbors are added up, B3/S23 comes down to one compare: a cell
+ * is alive next generation if (neighbors | cell) == 3. With 3 neighbors that's
+ * always true, with 2 it's only true if the cell is already alive, and no
+ * other count can make 3. Other rules compare against every count they use,
+ * see rule.h for how each rule gets its own copy of the kernels.
+*/
+
+#include <SDL2/SDL.h>
+#include "bytekernel.h"
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define BYTE_KERNEL_X86
+#include <immintrin.h>
+#endif
+
+#if defined(__ARM_NEON) || defined(_M_ARM64)
+#define BYTE_KERNEL_NEON
+#include <arm_neon.h>
+#endif
+
+// Lets the AVX2 kernel be compiled without -mavx2 for the whole program,
+// MSVC doesn't need to be told
+#if defined(__GNUC__) || defined(__clang__)
+#define TARGET(x) __attribute__((target(x)))
+#else
+#define TARGET(x)
+#endif
+
+// Whatever is left over at the end of the row when it doesn't fill a whole
+// vector
+RULE_INLINE void byte_tail(const uint8_t* above, const uint8_t* row, const uint8_t* below, uint8_t* out, int start, int end, unsigned birth, unsigned survive, byte_changes* changes)
+{
+    for (int x = start; x < end; x++)
+    {
+        int sum = above[x - 1] + above[x] + above[x + 1]
+                + row[x - 1] + row[x + 1]
+                + below[x - 1] + below[x] + below[x + 1];
+
+        if (birth == RULE_LIFE_BIRTH && survive == RULE_LIFE_SURVIVE)
+            out[x] = (sum | row[x]) == 3;
+        else
+            out[x] = (uint8_t)rule_next(birth, survive, row[x], sum);
+
+        if (changes)
+        {
+            changes->births += out[x] & ~row[x];
+            changes->deaths += row[x] & ~out[x];
+        }
+    }
+}
+
+// Every kernel below does the same thing once the neighbors are added up:
+// every count the rule uses gets compared against the sums, and the birth
+// or survival result is picked depending on whether the cell is alive.
+// With the masks as constants only the counts the rule has are compared.
+//
+// Births are cells that are 1 next generation and 0 now, and deaths the
+// other way around. Summing the bytes of those with a SAD against zero adds
+// them up into 64 bit lanes, which can't overflow.
+
+#ifdef BYTE_KERNEL_X86
+TARGET("avx2")
+RULE_INLINE void byte_avx2(const uint8_t* above, const uint8_t* row, const uint8_t* below, uint8_t* out, int start, int end, unsigned birth, unsigned survive, byte_changes* changes)
+{
+    const __m256i three = _mm256_set1_epi8(3);
+    const __m256i one = _mm256_set1_epi8(1);
+    __m256i births = _mm256_setzero_si256();
+    __m256i deaths = _mm256_setzero_si256();
+    int x = start;
+
+    for (; x + 32 <= end; x += 32)
+    {
+        #define LOAD(p) _mm256_loadu_si256((const __m256i*)(p))
+        __m256i cell = LOAD(&row[x]);
+        __m256i sum = _mm256_add_epi8(LOAD(&above[x - 1]), LOAD(&above[x]));
+        sum = _mm256_add_epi8(sum, LOAD(&above[x + 1]));
+        sum = _mm256_add_epi8(sum, LOAD(&row[x - 1]));
+        sum = _mm256_add_epi8(sum, LOAD(&row[x + 1]));
+        sum = _mm256_add_epi8(sum, LOAD(&below[x - 1]));
+        sum = _mm256_add_epi8(sum, LOAD(&below[x]));
+        sum = _mm256_add_epi8(sum, LOAD(&below[x + 1]));
+        #undef LOAD
+
+        __m256i alive;
+
+        if (birth == RULE_LIFE_BIRTH && survive == RULE_LIFE_SURVIVE)
+        {
+            alive = _mm256_cmpeq_epi8(_mm256_or_si256(sum, cell), three);
+        }
+        else
+        {
+            __m256i born = _mm256_setzero_si256();
+            __m256i kept = _mm256_setzero_si256();
+
+            RULE_UNROLL
+            for (int n = 0; n <= 8; n++)
+            {
+                if (!((birth | survive) >> n & 1))
+                    continue;
+
+                __m256i count = _mm256_cmpeq_epi8(sum, _mm256_set1_epi8((char)n));
+
+                if (birth >> n & 1)
+                    born = _mm256_or_si256(born, count);
+                if (survive >> n & 1)
+                    kept = _mm256_or_si256(kept, count);
+            }
+
+            // All ones for live cells
+            __m256i live = _mm256_sub_epi8(_mm256_setzero_si256(), cell);
+            alive = _mm256_or_si256(_mm256_andnot_si256(live, born), _mm256_and_si256(live, kept));
+        }
+
+        __m256i next = _mm256_and_si256(alive, one);
+        _mm256_storeu_si256((__m256i*)&out[x], next);
+
+        if (changes)
+        {
+            births = _mm256_add_epi64(births, _mm256_sad_epu8(_mm256_andnot_si256(cell, next), _mm256_setzero_si256()));
+            deaths = _mm256_add_epi64(deaths, _mm256_sad_epu8(_mm256_andnot_si256(next, cell), _mm256_setzero_si256()));
+        }
+    }
+
+    if (changes)
+    {
+        uint64_t lanes[4];
+
+        _mm256_storeu_si256((__m256i*)lanes, births);
+        changes->births += lanes[0] + lanes[1] + lanes[2] + lanes[3];
+        _mm256_storeu_si256((__m256i*)lanes, deaths);
+        changes->deaths += lanes[0] + lanes[1] + lanes[2] + lanes[3];
+    }
+
+    byte_tail(above, row, below, out, x, end, birth, survive, changes);
+}
+
+TARGET("sse2")
+RULE_INLINE void byte_sse2(const uint8_t* above, const uint8_t* row, const uint8_t* below, uint8_t* out, int start, int end, unsigned birth, unsigned survive, byte_changes* changes)
+{
+    const __m128i three = _mm_set1_epi8(3);
+    const __m128i one = _mm_set1_epi8(1);
+    __m128i births = _mm_setzero_si128();
+    __m128i deaths = _mm_setzero_si128();
+    int x = start;
+
+    for (; x + 16 <= end; x += 16)
+    {
+        #define LOAD(p) _mm_loadu_si128((const __m128i*)(p))
+        __m128i cell = LOAD(&row[x]);
+        __m128i sum = _mm_add_epi8(LOAD(&above[x - 1]), LOAD(&above[x]));
+        sum = _mm_add_epi8(sum, LOAD(&above[x + 1]));
+        sum = _mm_add_epi8(sum, LOAD(&row[x - 1]));
+        sum = _mm_add_epi8(sum, LOAD(&row[x + 1]));
+        sum = _mm_add_epi8(sum, LOAD(&below[x - 1]));
+        sum = _mm_add_epi8(sum, LOAD(&below[x]));
+        sum = _mm_add_epi8(sum, LOAD(&below[x + 1]));
+        #undef LOAD
+
+        __m128i alive;
+
+        if (birth == RULE_LIFE_BIRTH && survive == RULE_LIFE_SURVIVE)
+        {
+            alive = _mm_cmpeq_epi8(_mm_or_si128(sum, cell), three);
+        }
+        else
+        {
+            __m128i born = _mm_setzero_si128();
+            __m128i kept = _mm_setzero_si128();
+
+            RULE_UNROLL
+            for (int n = 0; n <= 8; n++)
+            {
+                if (!((birth | survive) >> n & 1))
+                    continue;
+
+                __m128i count = _mm_cmpeq_epi8(sum, _mm_set1_epi8((char)n));
+
+                if (birth >> n & 1)
+                    born = _mm_or_si128(born, count);
+                if (survive >> n & 1)
+                    kept = _mm_or_si128(kept, count);
+            }
+
+            // All ones for live cells
+            __m128i live = _mm_sub_epi8(_mm_setzero_si128(), cell);
+            alive = _mm_or_si128(_mm_andnot_si128(live, born), _mm_and_si128(live, kept));
+        }
+
+        __m128i next = _mm_and_si128(alive, one);
+        _mm_storeu_si128((__m128i*)&out[x], next);
+
+        if (changes)
+        {
+            births = _mm_add_epi64(births, _mm_sad_epu8(_mm_andnot_si128(cell, next), _mm_setzero_si128()));
+            deaths = _mm_add_epi64(deaths, _mm_sad_epu8(_mm_andnot_si128(next, cell), _mm_setzero_si128()));
+        }
+    }
+
+    if (changes)
+    {
+        uint64_t lanes[2];
+
+        _mm_storeu_si128((__m128i*)lanes, births);
+        changes->births += lanes[0] + lanes[1];
+        _mm_storeu_si128((__m128i*)lanes, deaths);
+        changes->deaths += lanes[0] + lanes[1];
+    }
+
+    byte_tail(above, row, below, out, x, end, birth, survive, changes);
+}
+#endif
+
+#ifdef BYTE_KERNEL_NEON
+RULE_INLINE void byte_neon(const uint8_t* above, const uint8_t* row, const uint8_t* below, uint8_t* out, int start, int end, unsigned birth, unsigned survive, byte_changes* changes)
+{
+    const uint8x16_t three = vdupq_n_u8(3);
+    const uint8x16_t one = vdupq_n_u8(1);
+    uint64x2_t births = vdupq_n_u64(0);
+    uint64x2_t deaths = vdupq_n_u64(0);
+    int x = start;
+
+    for (; x + 16 <= end; x += 16)
+    {
+        uint8x16_t cell = vld1q_u8(&row[x]);
+        uint8x16_t sum = vaddq_u8(vld1q_u8(&above[x - 1]), vld1q_u8(&above[x]));
+        sum = vaddq_u8(sum, vld1q_u8(&above[x + 1]));
+        sum = vaddq_u8(sum, vld1q_u8(&row[x - 1]));
+        sum = vaddq_u8(sum, vld1q_u8(&row[x + 1]));
+        sum = vaddq_u8(sum, vld1q_u8(&below[x - 1]));
+        sum = vaddq_u8(sum, vld1q_u8(&below[x]));
+        sum = vaddq_u8(sum, vld1q_u8(&below[x + 1]));
+
+        uint8x16_t alive;
+
+        if (birth == RULE_LIFE_BIRTH && survive == RULE_LIFE_SURVIVE)
+        {
+            alive = vceqq_u8(vorrq_u8(sum, cell), three);
+        }
+        else
+        {
+            uint8x16_t born = vdupq_n_u8(0);
+            uint8x16_t kept = vdupq_n_u8(0);
+
+            RULE_UNROLL
+            for (int n = 0; n <= 8; n++)
+            {
+                if (!((birth | survive) >> n & 1))
+                    continue;
+
+                uint8x16_t count = vceqq_u8(sum, vdupq_n_u8((uint8_t)n));
+
+                if (birth >> n & 1)
+                    born = vorrq_u8(born, count);
+                if (survive >> n & 1)
+                    kept = vorrq_u8(kept, count);
+            }
+
+            // All ones for live cells
+            uint8x16_t live = vceqq_u8(cell, one);
+            alive = vbslq_u8(live, kept, born);
+        }
+
+        uint8x16_t next = vandq_u8(alive, one);
+        vst1q_u8(&out[x], next);
+
+        // No SAD here, pairwise adds widen the bytes up to 64 bits instead
+        if (changes)
+        {
+            births = vpadalq_u32(births, vpaddlq_u16(vpaddlq_u8(vbicq_u8(next, cell))));
+            deaths = vpadalq_u32(deaths, vpaddlq_u16(vpaddlq_u8(vbicq_u8(cell, next))));
+        }
+    }
+
+    if (changes)
+    {
+        changes->births += vgetq_lane_u64(births, 0) + vgetq_lane_u64(births, 1);
+        changes->deaths += vgetq_lane_u64(deaths, 0) + vgetq_lane_u64(deaths, 1);
+    }
+
+    byte_tail(above, row, below, out, x, end, birth, survive, changes);
+}
+#endif
+
+// A copy of every kernel for each specialized rule, and one that looks the
+// rule up for everything else
+#define BYTE_RULE_KERNELS(isa, target, name, birth, survive) \
+    target static void byte_##isa##_##name(const uint8_t* above, const uint8_t* row, const uint8_t* below, uint8_t* out, int start, int end, const rule* r, byte_changes* changes) \
+    { \
+        (void)r; \
+        byte_##isa(above, row, below, out, start, end, birth, survive, changes); \
+    }
+
+#define BYTE_ANY_KERNEL(isa, target) \
+    target static void byte_##isa##_any(const uint8_t* above, const uint8_t* row, const uint8_t* below, uint8_t* out, int start, int end, const rule* r, byte_changes* changes) \
+    { \
+        byte_##isa(above, row, below, out, start, end, r->birth, r->survive, changes); \
+    }
+
+typedef struct
+{
+    rule r;
+    byte_kernel kernel;
+} rule_kernel;
+
+#define BYTE_RULE_ENTRY(isa, name, birth, survive) { { birth, survive }, byte_##isa##_##name },
+
+#ifdef BYTE_KERNEL_X86
+#define AVX2_KERNELS(name, birth, survive) BYTE_RULE_KERNELS(avx2, TARGET("avx2"), name, birth, survive)
+#define AVX2_ENTRY(name, birth, survive) BYTE_RULE_ENTRY(avx2, name, birth, survive)
+#define SSE2_KERNELS(name, birth, survive) BYTE_RULE_KERNELS(sse2, TARGET("sse2"), name, birth, survive)
+#define SSE2_ENTRY(name, birth, survive) BYTE_RULE_ENTRY(sse2, name, birth, survive)
+
+RULE_SPECIALIZED(AVX2_KERNELS)
+RULE_SPECIALIZED(SSE2_KERNELS)
+BYTE_ANY_KERNEL(avx2, TARGET("avx2"))
+BYTE_ANY_KERNEL(sse2, TARGET("sse2"))
+
+static const rule_kernel avx2_kernels[] = { RULE_SPECIALIZED(AVX2_ENTRY) };
+static const rule_kernel sse2_kernels[] = { RULE_SPECIALIZED(SSE2_ENTRY) };
+#endif
+
+#ifdef BYTE_KERNEL_NEON
+#define NEON_KERNELS(name, birth, survive) BYTE_RULE_KERNELS(neon, , name, birth, survive)
+#define NEON_ENTRY(name, birth, survive) BYTE_RULE_ENTRY(neon, name, birth, survive)
+
+RULE_SPECIALIZED(NEON_KERNELS)
+BYTE_ANY_KERNEL(neon, )
+
+static const rule_kernel neon_kernels[] = { RULE_SPECIALIZED(NEON_ENTRY) };
+#endif
+
+// The specialized kernel for r out of kernels, or fallback if there isn't one
+static byte_kernel find_kernel(const rule_kernel* kernels, size_t count, const rule* r, byte_kernel fallback)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        if (rule_equal(r, &kernels[i].r))
+            return kernels[i].kernel;
+    }
+
+    return fallback;
+}
+
+byte_kernel byte_kernel_pick(const rule* r, const char** name)
+{
+#ifdef BYTE_KERNEL_X86
+    if (SDL_HasAVX2())
+    {
+        if (name)
+            *name = "avx2";
+        return find_kernel(avx2_kernels, SDL_arraysize(avx2_kernels), r, byte_avx2_any);
+    }
+    if (SDL_HasSSE2())
+    {
+        if (name)
+            *name = "sse2";
+        return find_kernel(sse2_kernels, SDL_arraysize(sse2_kernels), r, byte_sse2_any);
+    }
+#endif
+
+#ifdef BYTE_KERNEL_NEON
+    if (SDL_HasNEON())
+    {
+        if (name)
+            *name = "neon";
+        return find_kernel(neon_kernels, SDL_arraysize(neon_kernels), r, byte_neon_any);
+    }
+#endif
+
+    (void)r;
+
+    if (name)
+        *name = "scalar";
+    return NULL;
+}
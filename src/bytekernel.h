@@ -0,0 +1,36 @@
+/* bytekernel.h - Vectorized byte grid kernel
+ *
+ * Steps a run of cells in a one byte per cell row with SIMD instead of
+ * counting neighbors one cell at a time. The eight neighbor rows are just the
+ * row above, the row itself and the row below, loaded one cell to the left
+ * and one to the right, so adding those up with byte adds gives the neighbor
+ * count of 32 (AVX2) or 16 (SSE2/NEON) cells at once.
+ *
+ * Cells have to be exactly 0 or 1 for this to work.
+*/
+
+#ifndef BYTEKERNEL_H
+#define BYTEKERNEL_H
+
+#include <stdint.h>
+#include "rule.h"
+
+// Cells a kernel brought to life and killed, added to as it goes
+typedef struct
+{
+    uint64_t births;
+    uint64_t deaths;
+} byte_changes;
+
+// Write the next generation of cells [start, end) of row to out, following
+// r. Cells start - 1 and end have to exist in all three rows. If changes
+// isn't NULL the births and deaths get counted into it too.
+typedef void (*byte_kernel)(const uint8_t* above, const uint8_t* row, const uint8_t* below, uint8_t* out, int start, int end, const rule* r, byte_changes* changes);
+
+// Returns the fastest kernel this CPU can run for r, or NULL if there's
+// nothing better than the scalar loop. The kernel can be specialized for r,
+// so it has to be picked again when the rule changes. If name isn't NULL
+// it's set to what was picked.
+byte_kernel byte_kernel_pick(const rule* r, const char** name);
+
+#endif
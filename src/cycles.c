@@ -0,0 +1,52 @@
+/* cycles.c - Finding repeating generations
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include "cycles.h"
+
+typedef struct
+{
+    uint64_t hash;
+    uint64_t generation;
+    int used;
+} cycle_slot;
+
+struct cycles
+{
+    cycle_slot slots[CYCLE_SLOTS];
+};
+
+cycles* cycles_create(void)
+{
+    return calloc(1, sizeof(cycles));
+}
+
+void cycles_destroy(cycles* c)
+{
+    free(c);
+}
+
+void cycles_reset(cycles* c)
+{
+    memset(c, 0, sizeof(cycles));
+}
+
+int cycles_check(cycles* c, engine* e, uint64_t* period)
+{
+    uint64_t hash = engine_hash(e);
+    cycle_slot* slot = &c->slots[hash % CYCLE_SLOTS];
+
+    // Two different grids having the same 64 bit hash is unlikely enough to
+    // not bother comparing the grids themselves
+    int repeat = slot->used && slot->hash == hash && slot->generation < e->generation;
+
+    if (repeat)
+        *period = e->generation - slot->generation;
+
+    slot->hash = hash;
+    slot->generation = e->generation;
+    slot->used = 1;
+
+    return repeat;
+}
@@ -0,0 +1,35 @@
+/* cycles.h - Finding repeating generations
+ *
+ * Once a grid settles down into still lifes and oscillators, it goes
+ * through the exact same generations over and over. Every generation's hash
+ * (see hash.h) goes into a small table, and a generation whose hash is
+ * already there is a repeat of that earlier one. The difference between the
+ * two is the period: 1 for a grid that stopped changing, 2 for blinkers and
+ * so on.
+ *
+ * The table only has room for CYCLE_SLOTS generations and newer ones push
+ * older ones out, so very long periods can take a few extra rounds to be
+ * found, and ones past CYCLE_SLOTS might not be found at all.
+*/
+
+#ifndef CYCLES_H
+#define CYCLES_H
+
+#include <stdint.h>
+#include "engine.h"
+
+#define CYCLE_SLOTS 4096
+
+typedef struct cycles cycles;
+
+cycles* cycles_create(void);
+void cycles_destroy(cycles* c);
+
+// Forget every generation, to start over on another grid
+void cycles_reset(cycles* c);
+
+// Hash the engine's current generation and remember it. Returns 1 and sets
+// period if the same grid was seen period generations ago.
+int cycles_check(cycles* c, engine* e, uint64_t* period);
+
+#endif
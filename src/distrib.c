@@ -0,0 +1,738 @@
+/* distrib.c - Splitting the grid across ranks
+*/
+
+#include <SDL2/SDL.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "distrib.h"
+#include "transport.h"
+#include "headless.h"
+#include "savefile.h"
+#include "pattern.h"
+
+// Rows get gathered for saving a bit at a time, as many as fit in about
+// this many bytes
+#define GATHER_BYTES (1 << 20)
+
+// The blocks around a block, in the order the halos get traded with them
+static const int directions[8][2] =
+{
+    { -1, -1 }, { 0, -1 }, { 1, -1 },
+    { -1,  0 },            { 1,  0 },
+    { -1,  1 }, { 0,  1 }, { 1,  1 }
+};
+
+// One rank's part of the grid
+typedef struct
+{
+    const options* opts;
+    transport* t;
+
+    // Blocks across and down, and which one this is
+    int columns;
+    int rows;
+    int column;
+    int row;
+
+    // Cells [x, x + width) across and [y, y + height) down of the grid
+    int x;
+    int y;
+    int width;
+    int height;
+
+    // How many halo cells there are on each side, none along the edges of
+    // a grid that doesn't wrap
+    int left;
+    int top;
+    int right;
+    int bottom;
+
+    // The block and its halo, which is where the block's cells start
+    engine* sim;
+    workers* pool;
+
+    // One row of sim
+    uint8_t* cells;
+
+    // Halo cells on their way out and in, packed 8 to a byte the same way
+    // .gol files are
+    uint8_t* out;
+    uint8_t* in;
+
+    // Rows of the block on their way to rank 0 to be saved, packed the same
+    uint8_t* saving;
+
+    // Time spent trading halos, in performance counter ticks
+    Uint64 trading;
+} block;
+
+// Where part i of parts starts when size cells get split as evenly as they
+// can be
+static int split(int size, int parts, int i)
+{
+    return (int)((int64_t)size * i / parts);
+}
+
+static size_t packed_size(int width, int height)
+{
+    return (size_t)(width + 7) / 8 * height;
+}
+
+// Rows that get gathered at once when saving
+static int gather_rows(const options* opts)
+{
+    return opts->width < GATHER_BYTES ? GATHER_BYTES / opts->width : 1;
+}
+
+// Pick how many blocks across and down to split the grid into, which has
+// to come out as exactly ranks blocks that are at least halo cells across.
+// Out of those it's the one where the blocks have the least edge to trade,
+// which is where they're closest to square. Returns 0 if none of them are
+// big enough.
+static int layout(const options* opts, int ranks, int* columns, int* rows)
+{
+    double best = 0;
+    int found = 0;
+
+    for (int c = 1; c <= ranks; c++)
+    {
+        if (ranks % c != 0)
+            continue;
+
+        int r = ranks / c;
+
+        if (opts->width / c < opts->halo || opts->height / r < opts->halo)
+            continue;
+
+        double edge = (double)opts->width / c + (double)opts->height / r;
+
+        if (!found || edge < best)
+        {
+            best = edge;
+            *columns = c;
+            *rows = r;
+            found = 1;
+        }
+    }
+
+    return found;
+}
+
+// Rank of the block dx, dy away, or -1 if it's past the edge of a grid that
+// doesn't wrap
+static int neighbour(const block* b, int dx, int dy)
+{
+    int column = b->column + dx;
+    int row = b->row + dy;
+
+    if (b->opts->wrap)
+    {
+        column = (column + b->columns) % b->columns;
+        row = (row + b->rows) % b->rows;
+    }
+    else if (column < 0 || column >= b->columns || row < 0 || row >= b->rows)
+    {
+        return -1;
+    }
+
+    return row * b->columns + column;
+}
+
+// Which of the size cells along one side of the block go to the block in
+// direction d (-1, 0 or 1) along it, counted from the start of the block
+static void outgoing(int d, int size, int halo, int* start, int* length)
+{
+    *start = d > 0 ? size - halo : 0;
+    *length = d == 0 ? size : halo;
+}
+
+// Same for the halo cells that come in from direction d
+static void incoming(int d, int size, int halo, int* start, int* length)
+{
+    *start = d < 0 ? -halo : d > 0 ? size : 0;
+    *length = d == 0 ? size : halo;
+}
+
+// Pack the w x h cells at (x, y) of e into bits, a row at a time
+static void pack(engine* e, int x, int y, int w, int h, uint8_t* out)
+{
+    size_t stride = (size_t)(w + 7) / 8;
+    memset(out, 0, stride * h);
+
+    for (int row = 0; row < h; row++)
+    {
+        uint8_t* bits = &out[stride * row];
+
+        for (int column = 0; column < w; column++)
+        {
+            bits[column >> 3] |= e->get_cell(e, x + column, y + row) << (column & 7);
+        }
+    }
+}
+
+// And put them back, dead ones too since whatever was there is out of date
+static void unpack(engine* e, int x, int y, int w, int h, const uint8_t* in)
+{
+    size_t stride = (size_t)(w + 7) / 8;
+
+    for (int row = 0; row < h; row++)
+    {
+        const uint8_t* bits = &in[stride * row];
+
+        for (int column = 0; column < w; column++)
+        {
+            e->set_cell(e, x + column, y + row, (bits[column >> 3] >> (column & 7)) & 1);
+        }
+    }
+}
+
+// Send the edges of the block to the blocks around it, and fill in the
+// halo with theirs. One direction at a time, every rank sending the same
+// way at once, so nobody waits on someone who's waiting on them.
+static int trade_halos(block* b)
+{
+    Uint64 start = SDL_GetPerformanceCounter();
+    int halo = b->opts->halo;
+    int ok = 1;
+
+    for (int i = 0; ok && i < 8; i++)
+    {
+        int dx = directions[i][0];
+        int dy = directions[i][1];
+        int to = neighbour(b, dx, dy);
+        int from = neighbour(b, -dx, -dy);
+
+        int sx, sy, sw, sh;
+        outgoing(dx, b->width, halo, &sx, &sw);
+        outgoing(dy, b->height, halo, &sy, &sh);
+
+        int rx, ry, rw, rh;
+        incoming(-dx, b->width, halo, &rx, &rw);
+        incoming(-dy, b->height, halo, &ry, &rh);
+
+        if (to >= 0)
+            pack(b->sim, b->left + sx, b->top + sy, sw, sh, b->out);
+
+        ok = b->t->exchange(b->t, to, b->out, packed_size(sw, sh), from, b->in, packed_size(rw, rh));
+
+        if (ok && from >= 0)
+            unpack(b->sim, b->left + rx, b->top + ry, rw, rh, b->in);
+    }
+
+    b->trading += SDL_GetPerformanceCounter() - start;
+    return ok;
+}
+
+// Pack rows [first, last) of the grid, which have to be in this block,
+// leaving out the halo
+static void pack_rows(block* b, int first, int last, uint8_t* out)
+{
+    size_t stride = (size_t)(b->width + 7) / 8;
+    memset(out, 0, stride * (last - first));
+
+    for (int y = first; y < last; y++)
+    {
+        b->sim->get_row(b->sim, b->top + y - b->y, b->cells);
+
+        const uint8_t* row = &b->cells[b->left];
+        uint8_t* bits = &out[stride * (y - first)];
+
+        for (int x = 0; x < b->width; x++)
+        {
+            bits[x >> 3] |= row[x] << (x & 7);
+        }
+    }
+}
+
+// Rank 0's side of saving, the rows for savefile_stream()
+typedef struct
+{
+    block* b;
+
+    // Rows [first, first + count) of the whole grid, one byte per cell
+    uint8_t* cells;
+    int first;
+    int count;
+
+    // Somebody's share of them as they come in
+    uint8_t* packed;
+
+    // 0 once a message didn't make it, after which it's all dead cells
+    int ok;
+} gather;
+
+static void gather_row(void* data, int y, uint8_t* out)
+{
+    gather* g = data;
+    block* b = g->b;
+    int width = b->opts->width;
+
+    if (y < g->first || y >= g->first + g->count)
+    {
+        // As many rows as fit, without going past the row of blocks y is in
+        int row = 0;
+        while (split(b->opts->height, b->rows, row + 1) <= y)
+            row++;
+
+        int count = split(b->opts->height, b->rows, row + 1) - y;
+        if (count > gather_rows(b->opts))
+            count = gather_rows(b->opts);
+
+        memset(g->cells, 0, (size_t)width * count);
+
+        for (int column = 0; g->ok && column < b->columns; column++)
+        {
+            int rank = row * b->columns + column;
+            int x = split(width, b->columns, column);
+            int w = split(width, b->columns, column + 1) - x;
+
+            if (rank == 0)
+            {
+                pack_rows(b, y, y + count, g->packed);
+            }
+            else
+            {
+                int64_t request[2] = { y, y + count };
+                g->ok = b->t->send(b->t, rank, request, sizeof(request))
+                    && b->t->recv(b->t, rank, g->packed, packed_size(w, count));
+            }
+
+            size_t stride = (size_t)(w + 7) / 8;
+
+            for (int r = 0; g->ok && r < count; r++)
+            {
+                const uint8_t* bits = &g->packed[stride * r];
+                uint8_t* cells = &g->cells[(size_t)width * r + x];
+
+                for (int c = 0; c < w; c++)
+                {
+                    cells[c] = (bits[c >> 3] >> (c & 7)) & 1;
+                }
+            }
+        }
+
+        g->first = y;
+        g->count = count;
+    }
+
+    memcpy(out, &g->cells[(size_t)width * (y - g->first)], width);
+}
+
+// Everyone else's side, sending rows whenever rank 0 asks for them until
+// it says it's done
+static int serve_rows(block* b)
+{
+    for (;;)
+    {
+        int64_t request[2];
+
+        if (!b->t->recv(b->t, 0, request, sizeof(request)))
+            return 0;
+        if (request[0] < 0)
+            return 1;
+
+        int first = (int)request[0];
+        int last = (int)request[1];
+
+        pack_rows(b, first, last, b->saving);
+
+        if (!b->t->send(b->t, 0, b->saving, packed_size(b->width, last - first)))
+            return 0;
+    }
+}
+
+// Save the whole grid to path on rank 0, every rank has to call it
+static int save_gathered(block* b, const char* path)
+{
+    if (b->t->rank != 0)
+        return serve_rows(b);
+
+    const options* opts = b->opts;
+    int rows = gather_rows(opts);
+
+    gather g = { b, malloc((size_t)opts->width * rows), 0, 0, malloc(packed_size(opts->width, rows)), 1 };
+
+    int ok = g.cells && g.packed
+        && savefile_stream(path, opts->width, opts->height, b->sim->generation, gather_row, &g)
+        && g.ok;
+
+    int64_t done[2] = { -1, -1 };
+
+    for (int i = 1; i < b->t->ranks; i++)
+    {
+        b->t->send(b->t, i, done, sizeof(done));
+    }
+
+    free(g.cells);
+    free(g.packed);
+    return ok;
+}
+
+// Every rank loads the whole pattern into a sparse engine, which only
+// takes as much memory as there are live cells, and copies its block out
+static int load_block(block* b)
+{
+    const options* opts = b->opts;
+
+    engine* whole = sparse_engine_create(opts->width, opts->height);
+    uint8_t* row = malloc(opts->width);
+
+    int ok = whole && row && pattern_load(opts->in, whole, opts->offset_x, opts->offset_y);
+
+    for (int y = 0; ok && y < b->height; y++)
+    {
+        whole->get_row(whole, b->y + y, row);
+
+        for (int x = 0; x < b->width; x++)
+        {
+            if (row[b->x + x])
+                b->sim->set_cell(b->sim, b->left + x, b->top + y, 1);
+        }
+    }
+
+    if (ok)
+        b->sim->generation = whole->generation;
+
+    if (whole)
+        whole->destroy(whole);
+
+    free(row);
+    return ok;
+}
+
+// Make the block's engine and load its part of the grid. Every rank comes
+// to the same conclusion about anything that's wrong with the options, so
+// only rank 0 says so.
+static int block_init(block* b)
+{
+    const options* opts = b->opts;
+    int rank = b->t->rank;
+    int halo = opts->halo;
+
+    if (!layout(opts, b->t->ranks, &b->columns, &b->rows))
+    {
+        if (rank == 0)
+            printf("A %dx%d grid can't be split into %d blocks with room for a halo of %d\n", opts->width, opts->height, b->t->ranks, halo);
+        return 0;
+    }
+
+    b->column = rank % b->columns;
+    b->row = rank / b->columns;
+
+    b->x = split(opts->width, b->columns, b->column);
+    b->y = split(opts->height, b->rows, b->row);
+    b->width = split(opts->width, b->columns, b->column + 1) - b->x;
+    b->height = split(opts->height, b->rows, b->row + 1) - b->y;
+
+    b->left = neighbour(b, -1, 0) >= 0 ? halo : 0;
+    b->top = neighbour(b, 0, -1) >= 0 ? halo : 0;
+    b->right = neighbour(b, 1, 0) >= 0 ? halo : 0;
+    b->bottom = neighbour(b, 0, 1) >= 0 ? halo : 0;
+
+    int width = b->left + b->width + b->right;
+    int height = b->top + b->height + b->bottom;
+
+    b->sim = engine_create(opts->engine, width, height);
+
+    if (!b->sim)
+    {
+        printf("Rank %d is unable to create a %dx%d grid with the \"%s\" engine!\n", rank, width, height, opts->engine);
+        return 0;
+    }
+
+    if (b->sim->unbounded)
+    {
+        if (rank == 0)
+            printf("The \"%s\" engine has no edges to split the grid along, use byte, bit or tile\n", opts->engine);
+        return 0;
+    }
+
+    if (!engine_set_rule(b->sim, &opts->rule))
+    {
+        if (rank == 0)
+            printf("The \"%s\" engine can only run B3/S23!\n", opts->engine);
+        return 0;
+    }
+
+    if (opts->threads != 1)
+    {
+        b->pool = workers_create(opts->threads);
+
+        if (!b->pool)
+        {
+            printf("Rank %d is unable to start %d worker threads!\n", rank, opts->threads);
+            return 0;
+        }
+
+        b->sim->pool = b->pool;
+    }
+
+    size_t across = packed_size(b->width, halo);
+    size_t down = packed_size(halo, b->height);
+    size_t strip = across > down ? across : down;
+
+    b->cells = malloc(width);
+    b->out = malloc(strip);
+    b->in = malloc(strip);
+    b->saving = malloc(packed_size(b->width, gather_rows(opts)));
+
+    if (!b->cells || !b->out || !b->in || !b->saving)
+    {
+        printf("Rank %d is out of memory!\n", rank);
+        return 0;
+    }
+
+    if (opts->in && !load_block(b))
+    {
+        if (rank == 0)
+            printf("Unable to load %s!\n", opts->in);
+        return 0;
+    }
+
+    return 1;
+}
+
+static void block_free(block* b)
+{
+    if (b->sim)
+        b->sim->destroy(b->sim);
+
+    workers_destroy(b->pool);
+
+    free(b->cells);
+    free(b->out);
+    free(b->in);
+    free(b->saving);
+}
+
+// Live cells in the block, not counting the halo
+static uint64_t block_population(block* b)
+{
+    uint64_t population = 0;
+
+    for (int y = 0; y < b->height; y++)
+    {
+        b->sim->get_row(b->sim, b->top + y, b->cells);
+
+        for (int x = 0; x < b->width; x++)
+        {
+            population += b->cells[b->left + x];
+        }
+    }
+
+    return population;
+}
+
+// Trade halos and step until the next trade, now and then stopping for
+// every rank to save a checkpoint together
+static int block_run(block* b)
+{
+    const options* opts = b->opts;
+    uint64_t total = (uint64_t)opts->gens;
+    uint64_t every = (uint64_t)opts->checkpoint_every;
+    uint64_t done = 0;
+    int ok = 1;
+
+    while (ok && done < total)
+    {
+        uint64_t gens = total - done;
+
+        if (gens > (uint64_t)opts->halo)
+            gens = opts->halo;
+        if (every && gens > every - done % every)
+            gens = every - done % every;
+
+        ok = trade_halos(b);
+        engine_advance(b->sim, gens);
+        done += gens;
+
+        if (every && done % every == 0)
+        {
+            char path[1024];
+            headless_checkpoint_path(opts, b->sim->generation, path, sizeof(path));
+
+            if (!save_gathered(b, path) && b->t->rank == 0)
+                printf("Unable to save %s!\n", path);
+        }
+    }
+
+    return ok;
+}
+
+// Everything one rank does, returns the exit code for main()
+static int rank_main(const options* opts, transport* t)
+{
+    block b;
+    memset(&b, 0, sizeof(b));
+
+    b.opts = opts;
+    b.t = t;
+
+    // Nobody starts until everybody's ready, or nobody does
+    int ok = block_init(&b);
+
+    if (transport_sum(t, !ok) != 0)
+    {
+        block_free(&b);
+        return -1;
+    }
+
+    Uint64 start = SDL_GetPerformanceCounter();
+
+    ok = block_run(&b);
+
+    transport_sum(t, 0);
+    Uint64 end = SDL_GetPerformanceCounter();
+
+    if (!ok)
+        printf("Rank %d lost touch with its neighbours!\n", t->rank);
+
+    uint64_t population = transport_sum(t, block_population(&b));
+    int result = ok ? 0 : -1;
+
+    if (t->rank == 0)
+    {
+        double seconds = (double)(end - start) / SDL_GetPerformanceFrequency();
+        double cells = (double)opts->width * opts->height;
+
+        printf("%llu generations of %dx%d on the %s engine in %.3f s, as %dx%d blocks on %d ranks with a halo of %d\n",
+            (unsigned long long)opts->gens, opts->width, opts->height, b.sim->name, seconds, b.columns, b.rows, t->ranks, opts->halo);
+
+        if (seconds > 0)
+        {
+            printf("%.1f generations/s, %.3g cell updates/s, %.1f%% of rank 0's time spent trading halos (and waiting for them)\n",
+                opts->gens / seconds, opts->gens * cells / seconds, 100.0 * b.trading / (end - start));
+        }
+
+        printf("%llu cells alive\n", (unsigned long long)population);
+    }
+
+    if (opts->out && !save_gathered(&b, opts->out) && t->rank == 0)
+    {
+        printf("Unable to save %s!\n", opts->out);
+        result = -1;
+    }
+
+    block_free(&b);
+    return result;
+}
+
+// The thread every local rank but rank 0 runs on. They all wait for go, so
+// none of them start if there's one that couldn't be made, which would
+// leave the others waiting for it forever.
+typedef struct
+{
+    const options* opts;
+    transport* t;
+    SDL_sem* go;
+    const int* abort;
+    int result;
+} rank_thread;
+
+static int rank_thread_main(void* data)
+{
+    rank_thread* r = data;
+    SDL_SemWait(r->go);
+
+    r->result = *r->abort ? -1 : rank_main(r->opts, r->t);
+    r->t->destroy(r->t);
+
+    return 0;
+}
+
+static int run_local(const options* opts)
+{
+    int ranks = opts->ranks;
+    transport** all = transport_create_local(ranks);
+    rank_thread* threads = calloc(ranks, sizeof(rank_thread));
+    SDL_Thread** handles = calloc(ranks, sizeof(SDL_Thread*));
+    SDL_sem* go = SDL_CreateSemaphore(0);
+    int abort = 0;
+
+    int ok = all && threads && handles && go;
+
+    if (!ok)
+        printf("Out of memory!\n");
+
+    for (int i = 1; ok && i < ranks; i++)
+    {
+        threads[i] = (rank_thread){ opts, all[i], go, &abort, 0 };
+        handles[i] = SDL_CreateThread(rank_thread_main, "gol rank", &threads[i]);
+
+        if (!handles[i])
+        {
+            printf("Unable to start the thread for rank %d!\n", i);
+            ok = 0;
+        }
+    }
+
+    abort = !ok;
+
+    for (int i = 1; handles && i < ranks; i++)
+    {
+        if (handles[i])
+            SDL_SemPost(go);
+    }
+
+    int result = ok ? rank_main(opts, all[0]) : -1;
+
+    for (int i = 0; all && i < ranks; i++)
+    {
+        if (handles && handles[i])
+        {
+            SDL_WaitThread(handles[i], NULL);
+
+            if (threads[i].result != 0)
+                result = -1;
+        }
+        else
+        {
+            all[i]->destroy(all[i]);
+        }
+    }
+
+    if (go)
+        SDL_DestroySemaphore(go);
+
+    free(all);
+    free(threads);
+    free(handles);
+    return result;
+}
+
+int distrib_run(const options* opts)
+{
+    if (!opts->headless)
+    {
+        printf("Only --headless runs can be split across ranks\n");
+        return -1;
+    }
+
+    if (opts->detect_cycles || opts->stats)
+    {
+        printf("--detect-cycles, --stop-on-cycle and --stats don't work across ranks\n");
+        return -1;
+    }
+
+    if (!opts->mpi)
+        return run_local(opts);
+
+#ifdef GOL_MPI
+    transport* t = transport_create_mpi();
+
+    if (!t)
+    {
+        printf("Unable to start MPI!\n");
+        return -1;
+    }
+
+    int result = rank_main(opts, t);
+    t->destroy(t);
+
+    return result;
+#else
+    printf("This build can't use MPI, build it with make mpi\n");
+    return -1;
+#endif
+}
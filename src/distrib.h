@@ -0,0 +1,39 @@
+/* distrib.h - Splitting the grid across ranks
+ *
+ * With --ranks N or --mpi a headless run gets split into a grid of
+ * rectangular blocks, as close to square as the number of ranks allows, and
+ * every rank steps its own block on an engine of its own. No rank ever has
+ * more of the grid than its block. Which ranks there are and how they talk
+ * is up to the transport (see transport.h): threads of this process for
+ * --ranks, or processes started by mpirun for --mpi.
+ *
+ * A cell's next generation depends on its neighbours, so the cells along
+ * the edges of a block need cells from the blocks around it. Every block's
+ * engine is bigger than the block by a halo of K cells on every side (K
+ * being --halo), where copies of the neighbouring blocks' cells go. Every K
+ * generations the ranks trade the K cells along each edge and corner with
+ * the eight blocks around them, and then step K generations on their own.
+ * Stepping makes the halo go wrong from the outside in, one cell every
+ * generation, so after K of them it's wrong all the way to the block but
+ * never in it. Bigger halos trade more cells, but K times less often, which
+ * is what matters when every message has to cross a network.
+ *
+ * Along the edges of a grid that doesn't wrap there's nobody to trade with
+ * and no halo, the engine's own edge is the grid's edge. With --wrap the
+ * blocks on one side trade with the ones on the other.
+ *
+ * Saving (--out and checkpoints) gathers the rows on rank 0 a few at a time
+ * as they get written, into the same .gol file a single engine would have
+ * saved.
+*/
+
+#ifndef DISTRIB_H
+#define DISTRIB_H
+
+#include "options.h"
+
+// Load opts->in, step opts->gens generations split across the ranks and
+// save to opts->out, like headless_run(). Returns the exit code for main().
+int distrib_run(const options* opts);
+
+#endif
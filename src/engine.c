@@ -0,0 +1,234 @@
+/* engine.c - Simulation engines
+ *
+ * Picks an engine by name and has the helpers that work with any engine.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include "engine.h"
+#include "hash.h"
+
+engine* engine_create(const char* name, int width, int height)
+{
+    if (strcmp(name, "byte") == 0)
+        return byte_engine_create(width, height);
+    if (strcmp(name, "bit") == 0)
+        return bit_engine_create(width, height);
+    if (strcmp(name, "tile") == 0)
+        return tile_engine_create(width, height);
+    if (strcmp(name, "hashlife") == 0)
+        return hashlife_engine_create(width, height);
+    if (strcmp(name, "sparse") == 0)
+        return sparse_engine_create(width, height);
+    if (strcmp(name, "gpu") == 0)
+        return gpu_engine_create(width, height);
+
+    return NULL;
+}
+
+int engine_advance(engine* e, uint64_t gens)
+{
+    e->out_of_memory = 0;
+
+    if (e->advance)
+    {
+        e->generation += e->advance(e, gens);
+        return !e->out_of_memory;
+    }
+
+    for (uint64_t i = 0; i < gens; i++)
+    {
+        e->step(e);
+
+        if (e->out_of_memory)
+            return 0;
+
+        e->generation++;
+    }
+
+    return 1;
+}
+
+uint64_t engine_hash(engine* e)
+{
+    if (e->hash)
+        return e->hash(e);
+
+    uint8_t* row = malloc(e->width);
+    if (!row)
+        return 0;
+
+    uint64_t words = ((uint64_t)e->width + 63) / 64;
+    uint64_t hash = 0;
+
+    for (int y = 0; y < e->height; y++)
+    {
+        e->get_row(e, y, row);
+
+        for (uint64_t i = 0; i < words; i++)
+        {
+            uint64_t word = 0;
+
+            for (int bit = 0; bit < 64 && i * 64 + bit < (uint64_t)e->width; bit++)
+            {
+                word |= (uint64_t)row[i * 64 + bit] << bit;
+            }
+
+            hash ^= hash_word(word, words * y + i);
+        }
+    }
+
+    free(row);
+    return hash;
+}
+
+uint64_t engine_population(engine* e)
+{
+    uint8_t* row = malloc(e->width);
+    if (!row)
+        return 0;
+
+    uint64_t count = 0;
+
+    for (int y = 0; y < e->height; y++)
+    {
+        e->get_row(e, y, row);
+
+        for (int x = 0; x < e->width; x++)
+        {
+            count += row[x];
+        }
+    }
+
+    free(row);
+    return count;
+}
+
+int engine_census(engine* e, census* out)
+{
+    if (e->take_census)
+        return e->take_census(e, out);
+
+    out->population = engine_population(e);
+    out->births = 0;
+    out->deaths = 0;
+    return 0;
+}
+
+int engine_set_wrap(engine* e, int wrap)
+{
+    if (!e->set_wrap)
+        return !wrap;
+
+    e->set_wrap(e, wrap);
+    return 1;
+}
+
+int engine_set_rule(engine* e, const rule* r)
+{
+    if (!e->set_rule)
+        return rule_equal(r, &e->rule);
+
+    e->set_rule(e, r);
+    return 1;
+}
+
+void engine_load_row_bits(engine* e, int y, const uint8_t* bits, int count)
+{
+    if (e->load_row_bits)
+    {
+        e->load_row_bits(e, y, bits, count);
+        return;
+    }
+
+    for (int x = 0; x < count; x++)
+    {
+        if ((bits[x >> 3] >> (x & 7)) & 1)
+            e->set_cell(e, x, y, 1);
+    }
+}
+
+int engine_get_row_bits(engine* e, int y, uint8_t* bits, int count)
+{
+    if (e->get_row_bits)
+        return e->get_row_bits(e, y, bits, count);
+
+    memset(bits, 0, ((size_t)count + 7) / 8);
+
+    uint8_t* row = malloc(e->width);
+    if (!row)
+        return 0;
+
+    e->get_row(e, y, row);
+
+    int alive = 0;
+
+    for (int x = 0; x < count; x++)
+    {
+        bits[x >> 3] |= row[x] << (x & 7);
+        alive += row[x];
+    }
+
+    free(row);
+    return alive;
+}
+
+void engine_count_blocks(engine* e, int shift, int bx, int by, int count, uint32_t* out)
+{
+    memset(out, 0, count * sizeof(uint32_t));
+
+    if (e->count_blocks)
+    {
+        e->count_blocks(e, shift, bx, by, count, out);
+        return;
+    }
+
+    // Only the part of it that's inside the grid can have anything alive
+    int64_t size = (int64_t)1 << shift;
+    int64_t x0 = bx * size;
+    int64_t y0 = by * size;
+    int64_t x_start = x0 > 0 ? x0 : 0;
+    int64_t x_end = x0 + count * size < e->width ? x0 + count * size : e->width;
+    int64_t y_start = y0 > 0 ? y0 : 0;
+    int64_t y_end = y0 + size < e->height ? y0 + size : e->height;
+
+    if (x_start >= x_end || y_start >= y_end)
+        return;
+
+    uint8_t* row = malloc(e->width);
+    if (!row)
+        return;
+
+    for (int64_t y = y_start; y < y_end; y++)
+    {
+        e->get_row(e, (int)y, row);
+
+        for (int64_t x = x_start; x < x_end; x++)
+        {
+            out[(x - x0) >> shift] += row[x];
+        }
+    }
+
+    free(row);
+}
+
+void engine_load(engine* e, const uint8_t* cells)
+{
+    for (int y = 0; y < e->height; y++)
+    {
+        for (int x = 0; x < e->width; x++)
+        {
+            // Old save files can still have the revive/die bits set, only
+            // the alive bit matters
+            e->set_cell(e, x, y, cells[(size_t)e->width * y + x] & CELL_ALIVE);
+        }
+    }
+}
+
+void engine_store(engine* e, uint8_t* cells)
+{
+    for (int y = 0; y < e->height; y++)
+    {
+        e->get_row(e, y, &cells[(size_t)e->width * y]);
+    }
+}
@@ -0,0 +1,204 @@
+/* engine.h - Simulation engines
+ *
+ * Every way of stepping the simulation lives behind this interface, so
+ * main.c doesn't have to care how the cells are actually stored. An engine
+ * owns its grid, and the front end only ever talks to it through these
+ * functions.
+ *
+ * Engines available:
+ *  - byte: one uint8_t per cell, the original loop from main.c or SIMD
+ *  - bit:  64 cells packed into each uint64_t, stepped with bitwise adders
+ *  - tile: the bit engine, but it skips 64x64 tiles where nothing is happening
+ *  - hashlife: a quadtree that remembers how every part of it played out
+ *    before, which can skip ahead huge numbers of generations at once. Cells
+ *    outside the grid keep living here, the grid is only what gets drawn.
+ *  - sparse: only the live cells, in a hash table. Also has no edges, and
+ *    takes as long to step as there are live cells, no matter where they are.
+ *  - gpu: the grid is a texture in GPU memory, stepped by a shader and drawn
+ *    from where it is
+*/
+
+#ifndef ENGINE_H
+#define ENGINE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "workers.h"
+#include "rule.h"
+
+// A live cell, in grids of one byte per cell (the byte engine's, and
+// engine_load()/engine_store())
+#define CELL_ALIVE 0x1
+
+typedef struct engine engine;
+
+// How many cells are alive, and how many have been born and died, see
+// engine_census()
+typedef struct
+{
+    uint64_t population;
+
+    // Added up over every generation stepped since the engine started
+    // counting, so the difference between two of these is what happened
+    // in between
+    uint64_t births;
+    uint64_t deaths;
+} census;
+
+struct engine
+{
+    // Name used to pick the engine from the command line
+    const char* name;
+
+    // Grid size in cells
+    int width;
+    int height;
+
+    // If set, each generation is split into bands of rows that are stepped
+    // on these threads. NULL steps everything on the calling thread.
+    workers* pool;
+
+    // Generations stepped with engine_advance() since the engine was created,
+    // or the generation of the last file loaded into it
+    uint64_t generation;
+
+    // 1 if the grid wraps around at the edges (a torus), 0 if everything
+    // outside the grid is dead. Use engine_set_wrap() to change it.
+    int wrap;
+
+    // Which Life-like rule the cells follow, B3/S23 unless changed with
+    // engine_set_rule()
+    rule rule;
+
+    // 1 if the universe goes on past the edges of the grid (hashlife and
+    // sparse), so there's something to see when looking outside of it
+    int unbounded;
+
+    // Set by engines that allocate as they go (hashlife and sparse) when
+    // they run out of memory stepping or setting a cell. Whatever needed the
+    // memory didn't happen and the grid is the way it was before it, so it
+    // can be tried again once there's more.
+    int out_of_memory;
+
+    // Advance the simulation by one generation
+    void (*step)(engine* e);
+
+    // Advance the simulation by a lot of generations at once, returning how
+    // many it got through, which is only less than gens if it ran out of
+    // memory. NULL if the engine can't do better than calling step over and
+    // over, use engine_advance() instead of calling this directly.
+    uint64_t (*advance)(engine* e, uint64_t gens);
+
+    // Read/write a single cell, 1 is alive and 0 is dead
+    uint8_t (*get_cell)(engine* e, int x, int y);
+    void (*set_cell)(engine* e, int x, int y, uint8_t alive);
+
+    // Copy a whole row out as one byte per cell, used for drawing
+    void (*get_row)(engine* e, int y, uint8_t* out);
+
+    // Count the live cells in a row of count blocks of 2^shift x 2^shift
+    // cells into out, which starts out zeroed. Block (bx, by) is cells
+    // [bx * 2^shift, (bx + 1) * 2^shift) across and the same down, and
+    // blocks can be partly or completely outside the grid. Used for drawing
+    // zoomed out, so it should take about as long as there are blocks
+    // rather than cells. NULL if the engine can't do better than get_row,
+    // use engine_count_blocks() instead of calling this directly.
+    void (*count_blocks)(engine* e, int shift, int bx, int by, int count, uint32_t* out);
+
+    // Bring cells [0, count) of row y to life wherever their bit is set in
+    // bits, cell x being bit (x % 8) of byte (x / 8). Cells with a 0 bit are
+    // left alone. NULL if the engine can't do better than set_cell, use
+    // engine_load_row_bits() instead of calling this directly.
+    void (*load_row_bits)(engine* e, int y, const uint8_t* bits, int count);
+
+    // The other way around: fill bits with cells [0, count) of row y, laid
+    // out the same way, and return how many of them are alive. Bits past
+    // count in the last byte are 0. NULL if the engine can't do better than
+    // get_row, use engine_get_row_bits() instead of calling this directly.
+    int (*get_row_bits)(engine* e, int y, uint8_t* bits, int count);
+
+    // Kill every cell
+    void (*clear)(engine* e);
+
+    // Switch wrapping around at the edges on or off. NULL if the engine
+    // can't wrap, use engine_set_wrap() instead of calling this directly.
+    void (*set_wrap)(engine* e, int wrap);
+
+    // Switch to a different rule. NULL if the engine only knows B3/S23, use
+    // engine_set_rule() instead of calling this directly.
+    void (*set_rule)(engine* e, const rule* r);
+
+    // Hash of the current generation, see hash.h. Every engine gives the
+    // same hash for the same grid. NULL if the engine doesn't keep track of
+    // it, use engine_hash() instead of calling this directly.
+    uint64_t (*hash)(engine* e);
+
+    // Live cells, and the births and deaths so far. Engines that don't
+    // count by default start on the first call, and from then on every step
+    // counts them as it goes instead of taking another pass over the grid.
+    // For hashlife and sparse it's every cell, not just the ones in the
+    // grid. Returns 0 if the engine only knows the population. NULL if the
+    // engine doesn't count, use engine_census() instead of calling this
+    // directly.
+    int (*take_census)(engine* e, census* out);
+
+    // The OpenGL texture the grid is in, one GL_R8UI texel per cell and row
+    // y of the grid in row y of the texture, so the window can draw it
+    // without it ever leaving the GPU (see gpuview.h). Only good until the
+    // next call to the engine. NULL if the grid isn't on the GPU.
+    unsigned int (*texture)(engine* e);
+
+    // How many bytes of memory the engine is using right now
+    size_t (*memory)(engine* e);
+
+    // Free the engine and everything it owns
+    void (*destroy)(engine* e);
+};
+
+// Create an engine by name, returns NULL if the name is unknown
+engine* engine_create(const char* name, int width, int height);
+
+// Advance by gens generations, as fast as the engine can. Returns 0 if the
+// engine ran out of memory (see out_of_memory) before getting through all
+// of them, and then the generation is as far as it got.
+int engine_advance(engine* e, uint64_t gens);
+
+// Hash the current generation, from the engine if it keeps track or from
+// every row of the grid if it doesn't
+uint64_t engine_hash(engine* e);
+
+// How many cells in the grid are alive, counted from every row of it, so
+// unlike the census it never counts anything past the edges
+uint64_t engine_population(engine* e);
+
+// See take_census above. Engines that don't count get the population
+// counted from every row of the grid, and 0 births and deaths.
+int engine_census(engine* e, census* out);
+
+// Make the grid wrap around at the edges or not, returns 0 if the engine
+// can't do that
+int engine_set_wrap(engine* e, int wrap);
+
+// Make the cells follow a different rule, returns 0 if the engine can't do
+// that
+int engine_set_rule(engine* e, const rule* r);
+
+// See load_row_bits and get_row_bits above
+void engine_load_row_bits(engine* e, int y, const uint8_t* bits, int count);
+int engine_get_row_bits(engine* e, int y, uint8_t* bits, int count);
+
+// See count_blocks above
+void engine_count_blocks(engine* e, int shift, int bx, int by, int count, uint32_t* out);
+
+// Copy a whole grid in or out of an engine, one byte per cell
+void engine_load(engine* e, const uint8_t* cells);
+void engine_store(engine* e, uint8_t* cells);
+
+engine* byte_engine_create(int width, int height);
+engine* bit_engine_create(int width, int height);
+engine* tile_engine_create(int width, int height);
+engine* hashlife_engine_create(int width, int height);
+engine* sparse_engine_create(int width, int height);
+engine* gpu_engine_create(int width, int height);
+
+#endif
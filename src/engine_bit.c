@@ -0,0 +1,814 @@
+/* engine_bit.c - Bit-packed engines
+ *
+ * 64 cells are packed into every uint64_t and a whole word of cells is
+ * stepped at once, see bitkernel.h for how.
+ *
+ * Every row has an extra word on each side of it, which gets filled with
+ * what's past the edge of the grid before every step: nothing, or the cells
+ * on the other side if the grid wraps around. Bits past the edge in the last
+ * word of a row are dead too, except for the first one, which holds cell 0
+ * while stepping a grid that wraps. They're masked off again in the result.
+ *
+ * The tile engine is the same thing, except the grid is also split into
+ * tiles of 64x64 cells (one word across and 64 rows down). A tile only gets
+ * stepped if it or one of the 8 tiles around it changed in the last
+ * generation, everything else is left alone. On mostly empty grids, or once
+ * things settle down, almost every tile gets skipped.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include "engine.h"
+#include "aligned.h"
+#include "bitkernel.h"
+#include "hash.h"
+
+// Rows per tile, tiles are always one word across
+#define TILE_ROWS 64
+
+// Tile population that has to be counted again before it gets used
+#define TILE_UNCOUNTED UINT16_MAX
+
+typedef struct bit_engine bit_engine;
+
+// What stepping one band of rows found out, each band has its own so the
+// threads don't have to share
+typedef struct
+{
+    // How the hash changed
+    uint64_t hash;
+
+    // Cells that were born and died
+    uint64_t births;
+    uint64_t deaths;
+} bit_band;
+
+// Steps rows (or rows of tiles) [start, end), one of these for every rule
+// in RULE_SPECIALIZED and one that works for any rule
+typedef void (*bit_rows)(bit_engine* b, int start, int end, bit_band* band);
+
+struct bit_engine
+{
+    engine base;
+
+    // 64 bit words per row, and from one row to the next including the
+    // extra words on both sides
+    int words;
+    size_t stride;
+
+    // Which bits of the last word in a row are real cells
+    uint64_t tail_mask;
+
+    // Current and next generation, swapped after every step
+    uint64_t* rows;
+    uint64_t* next;
+
+    // A row of dead cells, used above the top and below the bottom row.
+    // Allocated with the extra words too, so use bit_row() on it.
+    uint64_t* empty;
+
+    // Only used by the tile engine, NULL otherwise.
+    // Which tiles changed in the last generation, and which ones changed in the
+    // generation being stepped right now. Swapped after every step too.
+    int tiles_x;
+    int tiles_y;
+    uint8_t* changed;
+    uint8_t* changed_next;
+
+    // Live cells in every tile of the current generation, also only for the
+    // tile engine. Tiles that changed are set to TILE_UNCOUNTED, and only get
+    // counted again once something asks for them. While births and deaths
+    // are being counted, tiles that have been counted stay up to date.
+    uint16_t* population;
+
+    // Hash of the current generation (see hash.h), only kept up to date once
+    // something asks for it. Steps only hash the words that changed.
+    int track_hash;
+    int hash_valid;
+    uint64_t hash;
+
+    // Population, births and deaths, also only counted once something asks
+    // for them. Steps count the bits that changed in every word they write.
+    int track_census;
+    census counts;
+
+    // One for every band of rows, while anything is being kept track of
+    bit_band* band;
+    int bands;
+
+    // Picked for the rule by bit_set_rule()
+    bit_rows step_rows;
+};
+
+// Row y of a grid, word 0 is the first real one
+static inline uint64_t* bit_row(const bit_engine* b, uint64_t* rows, int y)
+{
+    return &rows[b->stride * y + 1];
+}
+
+// Row y of the current generation, where y can be one past the top or the
+// bottom of the grid
+static inline const uint64_t* bit_row_at(const bit_engine* b, int y)
+{
+    int height = b->base.height;
+
+    if (y < 0 || y >= height)
+    {
+        if (!b->base.wrap)
+            return bit_row(b, b->empty, 0);
+
+        y = y < 0 ? height - 1 : 0;
+    }
+
+    return bit_row(b, b->rows, y);
+}
+
+// Fill in what's past the left and right edge of every row
+static void bit_fill_border(bit_engine* b)
+{
+    engine* e = &b->base;
+    int words = b->words;
+    int last = (e->width - 1) & 63;
+
+    for (int y = 0; y < e->height; y++)
+    {
+        uint64_t* row = bit_row(b, b->rows, y);
+        uint64_t first_cell = row[0] & 1;
+        uint64_t last_cell = (row[words - 1] >> last) & 1;
+
+        row[words - 1] &= b->tail_mask;
+
+        if (e->wrap)
+        {
+            row[-1] = last_cell << 63;
+            row[words] = first_cell;
+
+            if (last < 63)
+                row[words - 1] |= first_cell << (last + 1);
+        }
+        else
+        {
+            row[-1] = 0;
+            row[words] = 0;
+        }
+    }
+}
+
+// How the hash changes when word i of row y goes from old to now
+static inline uint64_t hash_change(const bit_engine* b, int y, int i, uint64_t old, uint64_t now)
+{
+    uint64_t index = (uint64_t)b->words * y + i;
+    return old != now ? hash_word(old, index) ^ hash_word(now, index) : 0;
+}
+
+// Step rows [start, end) from rows into next. Rows are only ever read from
+// rows and written to next, so bands can run on different threads at once.
+// How the hash changed and the births and deaths go in band, if they're
+// being kept track of.
+RULE_INLINE void bit_step_rows(bit_engine* b, int start, int end, bit_band* band, unsigned birth, unsigned survive)
+{
+    int words = b->words;
+    uint64_t hash = 0;
+    uint64_t births = 0;
+    uint64_t deaths = 0;
+
+    for (int y = start; y < end; y++)
+    {
+        const uint64_t* above = bit_row_at(b, y - 1);
+        const uint64_t* row = bit_row(b, b->rows, y);
+        const uint64_t* below = bit_row_at(b, y + 1);
+        uint64_t* out = bit_row(b, b->next, y);
+
+        if (b->track_census)
+        {
+            // The same, counting the bits that changed while they're at hand
+            for (int i = 0; i < words; i++)
+            {
+                uint64_t mask = i == words - 1 ? b->tail_mask : UINT64_MAX;
+                uint64_t old = row[i] & mask;
+                uint64_t now = bit_step_word(above, row, below, i, birth, survive) & mask;
+
+                births += bit_count(now & ~old);
+                deaths += bit_count(old & ~now);
+                out[i] = now;
+            }
+        }
+        else
+        {
+            for (int i = 0; i < words; i++)
+            {
+                out[i] = bit_step_word(above, row, below, i, birth, survive);
+            }
+
+            out[words - 1] &= b->tail_mask;
+        }
+
+        if (b->track_hash)
+        {
+            for (int i = 0; i < words - 1; i++)
+            {
+                hash ^= hash_change(b, y, i, row[i], out[i]);
+            }
+
+            hash ^= hash_change(b, y, words - 1, row[words - 1] & b->tail_mask, out[words - 1]);
+        }
+    }
+
+    band->hash = hash;
+    band->births = births;
+    band->deaths = deaths;
+}
+
+// Did anything in the 3x3 tiles around (tx, ty) change last generation?
+static int tile_active(const bit_engine* b, int tx, int ty)
+{
+    for (int dy = -1; dy <= 1; dy++)
+    {
+        int y = ty + dy;
+
+        if (b->base.wrap)
+            y = (y + b->tiles_y) % b->tiles_y;
+        else if (y < 0 || y >= b->tiles_y)
+            continue;
+
+        for (int dx = -1; dx <= 1; dx++)
+        {
+            int x = tx + dx;
+
+            if (b->base.wrap)
+                x = (x + b->tiles_x) % b->tiles_x;
+            else if (x < 0 || x >= b->tiles_x)
+                continue;
+
+            if (b->changed[(size_t)b->tiles_x * y + x])
+                return 1;
+        }
+    }
+
+    return 0;
+}
+
+// Step the rows of tiles [start, end).
+// A tile that gets skipped didn't change last generation, so next still has
+// the exact same cells in it from two generations ago and can be left alone.
+RULE_INLINE void tile_step_rows(bit_engine* b, int start, int end, bit_band* band, unsigned birth, unsigned survive)
+{
+    engine* e = &b->base;
+    int words = b->words;
+    uint64_t hash = 0;
+    uint64_t births = 0;
+    uint64_t deaths = 0;
+
+    for (int ty = start; ty < end; ty++)
+    {
+        int y_start = ty * TILE_ROWS;
+        int y_end = y_start + TILE_ROWS < e->height ? y_start + TILE_ROWS : e->height;
+
+        for (int tx = 0; tx < b->tiles_x; tx++)
+        {
+            size_t tile = (size_t)b->tiles_x * ty + tx;
+
+            if (!tile_active(b, tx, ty))
+            {
+                b->changed_next[tile] = 0;
+                continue;
+            }
+
+            uint64_t mask = tx == words - 1 ? b->tail_mask : UINT64_MAX;
+            uint64_t diff = 0;
+            int born = 0;
+            int died = 0;
+
+            for (int y = y_start; y < y_end; y++)
+            {
+                const uint64_t* above = bit_row_at(b, y - 1);
+                const uint64_t* row = bit_row(b, b->rows, y);
+                const uint64_t* below = bit_row_at(b, y + 1);
+                uint64_t out = bit_step_word(above, row, below, tx, birth, survive) & mask;
+
+                bit_row(b, b->next, y)[tx] = out;
+                diff |= (out ^ row[tx]) & mask;
+
+                if (b->track_hash)
+                    hash ^= hash_change(b, y, tx, row[tx] & mask, out);
+
+                if (b->track_census)
+                {
+                    born += bit_count(out & ~row[tx]);
+                    died += bit_count(row[tx] & mask & ~out);
+                }
+            }
+
+            b->changed_next[tile] = diff != 0;
+
+            if (!diff)
+                continue;
+
+            if (b->track_census && b->population[tile] != TILE_UNCOUNTED)
+                b->population[tile] = (uint16_t)(b->population[tile] + born - died);
+            else
+                b->population[tile] = TILE_UNCOUNTED;
+
+            births += born;
+            deaths += died;
+        }
+    }
+
+    band->hash = hash;
+    band->births = births;
+    band->deaths = deaths;
+}
+
+// A copy of both for every specialized rule
+#define BIT_RULE_ROWS(name, birth, survive) \
+    static void bit_rows_##name(bit_engine* b, int start, int end, bit_band* band) { bit_step_rows(b, start, end, band, birth, survive); } \
+    static void tile_rows_##name(bit_engine* b, int start, int end, bit_band* band) { tile_step_rows(b, start, end, band, birth, survive); }
+
+RULE_SPECIALIZED(BIT_RULE_ROWS)
+
+// Everything else looks the rule up every time
+static void bit_rows_any(bit_engine* b, int start, int end, bit_band* band)
+{
+    bit_step_rows(b, start, end, band, b->base.rule.birth, b->base.rule.survive);
+}
+
+static void tile_rows_any(bit_engine* b, int start, int end, bit_band* band)
+{
+    tile_step_rows(b, start, end, band, b->base.rule.birth, b->base.rule.survive);
+}
+
+typedef struct
+{
+    rule r;
+    bit_rows bit;
+    bit_rows tile;
+} bit_kernel;
+
+#define BIT_RULE_KERNEL(name, birth, survive) { { birth, survive }, bit_rows_##name, tile_rows_##name },
+
+static const bit_kernel kernels[] =
+{
+    RULE_SPECIALIZED(BIT_RULE_KERNEL)
+};
+
+static void bit_step_band(void* ctx, int index, int count)
+{
+    bit_engine* b = ctx;
+    int start, end;
+
+    if (b->changed)
+        workers_band(b->tiles_y, index, count, &start, &end);
+    else
+        workers_band(b->base.height, index, count, &start, &end);
+
+    // Nothing needs what's in the band if nothing is being kept track of
+    bit_band unused;
+
+    b->step_rows(b, start, end, b->bands ? &b->band[index] : &unused);
+}
+
+static void bit_step(engine* e)
+{
+    bit_engine* b = (bit_engine*)e;
+
+    bit_fill_border(b);
+
+    int bands = e->pool ? workers_count(e->pool) : 1;
+
+    if ((b->track_hash || b->track_census) && bands > b->bands)
+    {
+        free(b->band);
+        b->band = calloc(bands, sizeof(bit_band));
+        b->bands = b->band ? bands : 0;
+
+        // Out of memory, so give up on them until they're asked for again
+        if (!b->band)
+        {
+            b->track_hash = 0;
+            b->hash_valid = 0;
+            b->track_census = 0;
+        }
+    }
+
+    if (e->pool)
+        workers_run(e->pool, bit_step_band, b);
+    else
+        bit_step_band(b, 0, 1);
+
+    for (int i = 0; (b->track_hash || b->track_census) && i < bands; i++)
+    {
+        b->hash ^= b->band[i].hash;
+
+        b->counts.births += b->band[i].births;
+        b->counts.deaths += b->band[i].deaths;
+        b->counts.population += b->band[i].births - b->band[i].deaths;
+    }
+
+    uint64_t* tmp = b->rows;
+    b->rows = b->next;
+    b->next = tmp;
+
+    if (b->changed)
+    {
+        uint8_t* tmp_changed = b->changed;
+        b->changed = b->changed_next;
+        b->changed_next = tmp_changed;
+    }
+}
+
+static uint8_t bit_get_cell(engine* e, int x, int y)
+{
+    bit_engine* b = (bit_engine*)e;
+    return (bit_row(b, b->rows, y)[x >> 6] >> (x & 63)) & 1;
+}
+
+static void bit_set_cell(engine* e, int x, int y, uint8_t alive)
+{
+    bit_engine* b = (bit_engine*)e;
+    uint64_t* word = &bit_row(b, b->rows, y)[x >> 6];
+
+    uint64_t old = *word;
+
+    if (alive)
+        *word |= (uint64_t)1 << (x & 63);
+    else
+        *word &= ~((uint64_t)1 << (x & 63));
+
+    // The last word of a row can have the bit past the edge set for
+    // wrapping around, which isn't a cell
+    if (b->hash_valid)
+    {
+        uint64_t mask = x >> 6 == b->words - 1 ? b->tail_mask : UINT64_MAX;
+        b->hash ^= hash_change(b, y, x >> 6, old & mask, *word & mask);
+    }
+
+    // Drawing a cell isn't a birth, it only changes the population
+    int change = (int)((*word >> (x & 63)) & 1) - (int)((old >> (x & 63)) & 1);
+
+    if (b->track_census)
+        b->counts.population += change;
+
+    // Make sure the tile and the ones around it get stepped next time
+    if (b->changed)
+    {
+        size_t tile = (size_t)b->tiles_x * (y / TILE_ROWS) + (x >> 6);
+
+        b->changed[tile] = 1;
+
+        if (b->population[tile] != TILE_UNCOUNTED)
+            b->population[tile] = (uint16_t)(b->population[tile] + change);
+    }
+}
+
+static void bit_get_row(engine* e, int y, uint8_t* out)
+{
+    bit_engine* b = (bit_engine*)e;
+    const uint64_t* row = bit_row(b, b->rows, y);
+
+    for (int x = 0; x < e->width; x++)
+    {
+        out[x] = (row[x >> 6] >> (x & 63)) & 1;
+    }
+}
+
+// Same as loading, the other way around: every word is taken apart into 8
+// bytes, only the last one has to be masked
+static int bit_get_row_bits(engine* e, int y, uint8_t* bits, int count)
+{
+    bit_engine* b = (bit_engine*)e;
+    const uint64_t* row = bit_row(b, b->rows, y);
+    int bytes = (count + 7) / 8;
+    int alive = 0;
+
+    for (int i = 0; i * 64 < count; i++)
+    {
+        uint64_t word = row[i];
+
+        if (count - i * 64 < 64)
+            word &= ((uint64_t)1 << (count - i * 64)) - 1;
+
+        alive += bit_count(word);
+
+        for (int k = 0; k < 8 && i * 8 + k < bytes; k++)
+        {
+            bits[i * 8 + k] = (uint8_t)(word >> (8 * k));
+        }
+    }
+
+    return alive;
+}
+
+// The bits are already laid out the same way as the words of a row, 8 bytes
+// just have to be put together into each word
+static void bit_load_row_bits(engine* e, int y, const uint8_t* bits, int count)
+{
+    bit_engine* b = (bit_engine*)e;
+    uint64_t* row = bit_row(b, b->rows, y);
+    int bytes = (count + 7) / 8;
+
+    for (int i = 0; i * 64 < count; i++)
+    {
+        uint64_t word = 0;
+
+        for (int k = 0; k < 8 && i * 8 + k < bytes; k++)
+        {
+            word |= (uint64_t)bits[i * 8 + k] << (8 * k);
+        }
+
+        if (count - i * 64 < 64)
+            word &= ((uint64_t)1 << (count - i * 64)) - 1;
+
+        int added = word ? bit_count(word & ~row[i]) : 0;
+
+        if (b->track_census)
+            b->counts.population += added;
+
+        if (b->changed && added)
+        {
+            size_t tile = (size_t)b->tiles_x * (y / TILE_ROWS) + i;
+
+            b->changed[tile] = 1;
+
+            if (b->population[tile] != TILE_UNCOUNTED)
+                b->population[tile] = (uint16_t)(b->population[tile] + added);
+        }
+
+        row[i] |= word;
+    }
+
+    b->hash_valid = 0;
+}
+
+static void bit_clear(engine* e)
+{
+    bit_engine* b = (bit_engine*)e;
+    b->hash_valid = 0;
+    b->counts.population = 0;
+    memset(b->rows, 0, b->stride * e->height * sizeof(uint64_t));
+
+    // Both generations have to be empty for the tile engine to be able to
+    // skip tiles that stay empty
+    if (b->changed)
+    {
+        memset(b->next, 0, b->stride * e->height * sizeof(uint64_t));
+        memset(b->changed, 0, (size_t)b->tiles_x * b->tiles_y);
+        memset(b->population, 0, (size_t)b->tiles_x * b->tiles_y * sizeof(uint16_t));
+    }
+}
+
+// Live cells in a tile, counted again if it changed since the last time
+static uint32_t tile_population(bit_engine* b, int tx, int ty)
+{
+    uint16_t* population = &b->population[(size_t)b->tiles_x * ty + tx];
+
+    if (*population == TILE_UNCOUNTED)
+    {
+        int y_start = ty * TILE_ROWS;
+        int y_end = y_start + TILE_ROWS < b->base.height ? y_start + TILE_ROWS : b->base.height;
+        uint64_t mask = tx == b->words - 1 ? b->tail_mask : UINT64_MAX;
+        int count = 0;
+
+        for (int y = y_start; y < y_end; y++)
+        {
+            count += bit_count(bit_row(b, b->rows, y)[tx] & mask);
+        }
+
+        *population = (uint16_t)count;
+    }
+
+    return *population;
+}
+
+// Blocks of whole tiles, which only need the tile populations added up
+static void tile_count_blocks(bit_engine* b, int shift, int bx, int by, int count, uint32_t* out)
+{
+    int64_t tiles = (int64_t)1 << (shift - 6);
+    int64_t ty_start = by * tiles > 0 ? by * tiles : 0;
+    int64_t ty_end = (by + 1) * tiles < b->tiles_y ? (by + 1) * tiles : b->tiles_y;
+
+    for (int64_t ty = ty_start; ty < ty_end; ty++)
+    {
+        for (int i = 0; i < count; i++)
+        {
+            int64_t tx_start = (bx + i) * tiles > 0 ? (bx + i) * tiles : 0;
+            int64_t tx_end = (bx + i + 1) * tiles < b->tiles_x ? (bx + i + 1) * tiles : b->tiles_x;
+
+            for (int64_t tx = tx_start; tx < tx_end; tx++)
+            {
+                out[i] += tile_population(b, (int)tx, (int)ty);
+            }
+        }
+    }
+}
+
+static void bit_count_blocks(engine* e, int shift, int bx, int by, int count, uint32_t* out)
+{
+    bit_engine* b = (bit_engine*)e;
+
+    // Tiles are 64x64, so blocks at least that big are made of whole tiles
+    if (b->population && shift >= 6)
+    {
+        tile_count_blocks(b, shift, bx, by, count, out);
+        return;
+    }
+
+    int64_t size = (int64_t)1 << shift;
+    int64_t y_start = by * size > 0 ? by * size : 0;
+    int64_t y_end = (by + 1) * size < e->height ? (by + 1) * size : e->height;
+
+    for (int64_t y = y_start; y < y_end; y++)
+    {
+        const uint64_t* row = bit_row(b, b->rows, (int)y);
+
+        for (int i = 0; i < count; i++)
+        {
+            int64_t x_start = (bx + i) * size > 0 ? (bx + i) * size : 0;
+            int64_t x_end = (bx + i + 1) * size < e->width ? (bx + i + 1) * size : e->width;
+
+            if (x_start < x_end)
+                out[i] += bit_count_range(row, (int)x_start, (int)x_end);
+        }
+    }
+}
+
+static uint64_t bit_hash(engine* e)
+{
+    bit_engine* b = (bit_engine*)e;
+
+    // From now on every step keeps the hash up to date
+    b->track_hash = 1;
+
+    if (!b->hash_valid)
+    {
+        b->hash = 0;
+
+        for (int y = 0; y < e->height; y++)
+        {
+            const uint64_t* row = bit_row(b, b->rows, y);
+
+            for (int i = 0; i < b->words; i++)
+            {
+                uint64_t word = i == b->words - 1 ? row[i] & b->tail_mask : row[i];
+                b->hash ^= hash_word(word, (uint64_t)b->words * y + i);
+            }
+        }
+
+        b->hash_valid = 1;
+    }
+
+    return b->hash;
+}
+
+static int bit_take_census(engine* e, census* out)
+{
+    bit_engine* b = (bit_engine*)e;
+
+    // From now on every step counts what changed
+    if (!b->track_census)
+    {
+        b->counts.population = 0;
+        b->counts.births = 0;
+        b->counts.deaths = 0;
+
+        for (int y = 0; y < e->height; y++)
+        {
+            const uint64_t* row = bit_row(b, b->rows, y);
+
+            for (int i = 0; i < b->words; i++)
+            {
+                b->counts.population += bit_count(i == b->words - 1 ? row[i] & b->tail_mask : row[i]);
+            }
+        }
+
+        b->track_census = 1;
+    }
+
+    *out = b->counts;
+    return 1;
+}
+
+static void bit_set_wrap(engine* e, int wrap)
+{
+    bit_engine* b = (bit_engine*)e;
+
+    // Tiles along the edges see different neighbors now, so step everything
+    // once to find out which tiles are still changing
+    if (b->changed && wrap != e->wrap)
+        memset(b->changed, 1, (size_t)b->tiles_x * b->tiles_y);
+
+    e->wrap = wrap;
+}
+
+static void bit_set_rule(engine* e, const rule* r)
+{
+    bit_engine* b = (bit_engine*)e;
+
+    e->rule = *r;
+    b->step_rows = b->changed ? tile_rows_any : bit_rows_any;
+
+    for (size_t i = 0; i < sizeof(kernels) / sizeof(kernels[0]); i++)
+    {
+        if (rule_equal(r, &kernels[i].r))
+            b->step_rows = b->changed ? kernels[i].tile : kernels[i].bit;
+    }
+
+    // Tiles that settled down under the old rule might not have under this
+    // one, so step everything once to find out
+    if (b->changed)
+        memset(b->changed, 1, (size_t)b->tiles_x * b->tiles_y);
+}
+
+static size_t bit_memory(engine* e)
+{
+    bit_engine* b = (bit_engine*)e;
+    size_t rows = b->stride * e->height * sizeof(uint64_t);
+    size_t tiles = (size_t)b->tiles_x * b->tiles_y;
+
+    return sizeof(bit_engine) + rows * 2 + b->stride * sizeof(uint64_t) + tiles * (2 + sizeof(uint16_t)) + b->bands * sizeof(bit_band);
+}
+
+static void bit_destroy(engine* e)
+{
+    bit_engine* b = (bit_engine*)e;
+    aligned_free(b->rows);
+    aligned_free(b->next);
+    aligned_free(b->empty);
+    aligned_free(b->changed);
+    aligned_free(b->changed_next);
+    aligned_free(b->population);
+    free(b->band);
+    free(b);
+}
+
+static bit_engine* bit_create(int width, int height)
+{
+    bit_engine* b = calloc(1, sizeof(bit_engine));
+    if (!b)
+        return NULL;
+
+    b->words = (width + 63) / 64;
+    b->stride = (size_t)b->words + 2;
+    b->tail_mask = width % 64 ? ((uint64_t)1 << (width % 64)) - 1 : UINT64_MAX;
+
+    b->rows = aligned_calloc(b->stride * height, sizeof(uint64_t));
+    b->next = aligned_calloc(b->stride * height, sizeof(uint64_t));
+    b->empty = aligned_calloc(b->stride, sizeof(uint64_t));
+
+    b->base.name = "bit";
+    b->base.width = width;
+    b->base.height = height;
+    b->base.step = bit_step;
+    b->base.get_cell = bit_get_cell;
+    b->base.set_cell = bit_set_cell;
+    b->base.get_row = bit_get_row;
+    b->base.load_row_bits = bit_load_row_bits;
+    b->base.get_row_bits = bit_get_row_bits;
+    b->base.count_blocks = bit_count_blocks;
+    b->base.clear = bit_clear;
+    b->base.hash = bit_hash;
+    b->base.take_census = bit_take_census;
+    b->base.set_wrap = bit_set_wrap;
+    b->base.set_rule = bit_set_rule;
+    b->base.memory = bit_memory;
+    b->base.destroy = bit_destroy;
+
+    if (!b->rows || !b->next || !b->empty)
+    {
+        bit_destroy((engine*)b);
+        return NULL;
+    }
+
+    bit_set_rule(&b->base, &rule_life);
+
+    return b;
+}
+
+engine* bit_engine_create(int width, int height)
+{
+    return (engine*)bit_create(width, height);
+}
+
+engine* tile_engine_create(int width, int height)
+{
+    bit_engine* b = bit_create(width, height);
+    if (!b)
+        return NULL;
+
+    b->base.name = "tile";
+    b->tiles_x = b->words;
+    b->tiles_y = (height + TILE_ROWS - 1) / TILE_ROWS;
+    b->changed = aligned_calloc((size_t)b->tiles_x * b->tiles_y, sizeof(uint8_t));
+    b->changed_next = aligned_calloc((size_t)b->tiles_x * b->tiles_y, sizeof(uint8_t));
+    b->population = aligned_calloc((size_t)b->tiles_x * b->tiles_y, sizeof(uint16_t));
+
+    if (!b->changed || !b->changed_next || !b->population)
+    {
+        bit_destroy((engine*)b);
+        return NULL;
+    }
+
+    // Now that it's a tile engine it needs the tile kernels
+    bit_set_rule(&b->base, &rule_life);
+
+    return (engine*)b;
+}
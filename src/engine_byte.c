@@ -0,0 +1,378 @@
+/* engine_byte.c - Byte grid engine
+ *
+ * The original simulation loop. Every cell gets its own uint8_t, which is
+ * exactly 0 or 1. Every generation is written into a second grid in one
+ * pass, and the two are swapped afterwards.
+ *
+ * Neighbors are counted with a sliding window of three rows of sums: for
+ * every row the sum of each cell and the ones left and right of it gets
+ * worked out once, and then a cell's neighbors are the sums above, at and
+ * below it minus the cell itself. Every row of the grid is only read once
+ * for that, instead of once for each of the three rows next to it. With
+ * SIMD (see bytekernel.h) the kernel adds up whole vectors of neighbors
+ * instead.
+ *
+ * The grid has a border of one extra cell all the way around it, so counting
+ * neighbors never has to check if it's at the edge. Before every step the
+ * border is filled with dead cells, or with a copy of the opposite edge if
+ * the grid wraps around.
+ *
+ * Once something asks for a census, births and deaths get counted as the
+ * next generation gets written.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include "engine.h"
+#include "aligned.h"
+#include "bytekernel.h"
+
+typedef struct
+{
+    engine base;
+
+    // Bytes from one row to the next, including the border
+    size_t stride;
+
+    uint8_t* cells;
+
+    // Next generation, swapped with cells after every step
+    uint8_t* next;
+
+    // NULL if the CPU has nothing better than the scalar loop, which looks
+    // the rule up for every cell
+    byte_kernel kernel;
+
+    // Population, births and deaths, only counted once something asks for
+    // them
+    int track_census;
+    census counts;
+
+    // Every band of rows has its own births and deaths, and its own three
+    // rows of sums (stride bytes each) for the scalar loop, so the threads
+    // don't have to share. There's room for bands of them.
+    byte_changes* band;
+    uint8_t* window;
+    int bands;
+} byte_engine;
+
+// Row y of a grid, from -1 (the border above) to height (the border below).
+// Cell -1 and cell width of every row are the border too.
+static inline uint8_t* byte_row(const byte_engine* b, uint8_t* cells, int y)
+{
+    return &cells[b->stride * (y + 1) + 1];
+}
+
+// Fill the border around the current generation
+static void byte_fill_border(byte_engine* b)
+{
+    int w = b->base.width;
+    int h = b->base.height;
+    int wrap = b->base.wrap;
+
+    for (int y = 0; y < h; y++)
+    {
+        uint8_t* row = byte_row(b, b->cells, y);
+        row[-1] = wrap ? row[w - 1] : 0;
+        row[w] = wrap ? row[0] : 0;
+    }
+
+    // Whole rows including the border cells, which takes care of the corners
+    uint8_t* top = byte_row(b, b->cells, -1) - 1;
+    uint8_t* bottom = byte_row(b, b->cells, h) - 1;
+
+    if (wrap)
+    {
+        memcpy(top, byte_row(b, b->cells, h - 1) - 1, b->stride);
+        memcpy(bottom, byte_row(b, b->cells, 0) - 1, b->stride);
+    }
+    else
+    {
+        memset(top, 0, b->stride);
+        memset(bottom, 0, b->stride);
+    }
+}
+
+// Sum of every cell with the ones left and right of it, for cells [0, w)
+static inline void byte_row_sums(const uint8_t* row, int w, uint8_t* sums)
+{
+    for (int x = 0; x < w; x++)
+    {
+        sums[x] = row[x - 1] + row[x] + row[x + 1];
+    }
+}
+
+// One band of rows. Rows only ever get read from cells and written to next,
+// so bands can run on different threads at once.
+static void byte_step_band(void* ctx, int index, int count)
+{
+    byte_engine* b = ctx;
+    int w = b->base.width;
+    unsigned birth = b->base.rule.birth;
+    unsigned survive = b->base.rule.survive;
+    int start, end;
+
+    workers_band(b->base.height, index, count, &start, &end);
+
+    byte_changes* changes = b->track_census ? &b->band[index] : NULL;
+
+    if (changes)
+    {
+        changes->births = 0;
+        changes->deaths = 0;
+    }
+
+    if (b->kernel)
+    {
+        for (int y = start; y < end; y++)
+        {
+            b->kernel(byte_row(b, b->cells, y - 1), byte_row(b, b->cells, y), byte_row(b, b->cells, y + 1),
+                byte_row(b, b->next, y), 0, w, &b->base.rule, changes);
+        }
+
+        return;
+    }
+
+    // The sums of the rows above, at and below the one being stepped. Moving
+    // down a row only needs the sums of the next one below.
+    uint8_t* above = &b->window[3 * b->stride * index + 1];
+    uint8_t* middle = above + b->stride;
+    uint8_t* below = middle + b->stride;
+
+    byte_row_sums(byte_row(b, b->cells, start - 1), w, above);
+    byte_row_sums(byte_row(b, b->cells, start), w, middle);
+
+    for (int y = start; y < end; y++)
+    {
+        const uint8_t* row = byte_row(b, b->cells, y);
+        uint8_t* out = byte_row(b, b->next, y);
+
+        byte_row_sums(byte_row(b, b->cells, y + 1), w, below);
+
+        for (int x = 0; x < w; x++)
+        {
+            int cell = row[x];
+            int next = rule_next(birth, survive, cell, above[x] + middle[x] + below[x] - cell);
+
+            out[x] = (uint8_t)next;
+
+            if (changes)
+            {
+                changes->births += next & ~cell;
+                changes->deaths += cell & ~next;
+            }
+        }
+
+        uint8_t* spare = above;
+        above = middle;
+        middle = below;
+        below = spare;
+    }
+}
+
+// Make room for bands of rows, returns 0 if there's no memory for them
+static int byte_fit_bands(byte_engine* b, int bands)
+{
+    if (bands <= b->bands)
+        return 1;
+
+    byte_changes* band = calloc(bands, sizeof(byte_changes));
+    uint8_t* window = malloc(3 * b->stride * bands);
+
+    if (!band || !window)
+    {
+        free(band);
+        free(window);
+        return 0;
+    }
+
+    free(b->band);
+    free(b->window);
+    b->band = band;
+    b->window = window;
+    b->bands = bands;
+
+    return 1;
+}
+
+static void byte_step(engine* e)
+{
+    byte_engine* b = (byte_engine*)e;
+    int bands = e->pool ? workers_count(e->pool) : 1;
+
+    byte_fill_border(b);
+
+    // Out of memory for more bands, so just step it all on this thread
+    if (!byte_fit_bands(b, bands))
+        bands = 1;
+
+    if (bands > 1)
+        workers_run(e->pool, byte_step_band, b);
+    else
+        byte_step_band(b, 0, 1);
+
+    for (int i = 0; b->track_census && i < bands; i++)
+    {
+        b->counts.births += b->band[i].births;
+        b->counts.deaths += b->band[i].deaths;
+        b->counts.population += b->band[i].births - b->band[i].deaths;
+    }
+
+    uint8_t* tmp = b->cells;
+    b->cells = b->next;
+    b->next = tmp;
+}
+
+static uint8_t byte_get_cell(engine* e, int x, int y)
+{
+    byte_engine* b = (byte_engine*)e;
+    return byte_row(b, b->cells, y)[x] & CELL_ALIVE;
+}
+
+static void byte_set_cell(engine* e, int x, int y, uint8_t alive)
+{
+    byte_engine* b = (byte_engine*)e;
+    uint8_t* cell = &byte_row(b, b->cells, y)[x];
+
+    // Drawing a cell isn't a birth, it only changes the population
+    if (b->track_census)
+        b->counts.population += (alive ? 1 : 0) - (*cell & CELL_ALIVE);
+
+    *cell = alive ? CELL_ALIVE : 0;
+}
+
+static void byte_get_row(engine* e, int y, uint8_t* out)
+{
+    byte_engine* b = (byte_engine*)e;
+    const uint8_t* row = byte_row(b, b->cells, y);
+
+    for (int x = 0; x < e->width; x++)
+    {
+        out[x] = row[x] & CELL_ALIVE;
+    }
+}
+
+static int byte_get_row_bits(engine* e, int y, uint8_t* bits, int count)
+{
+    byte_engine* b = (byte_engine*)e;
+    const uint8_t* row = byte_row(b, b->cells, y);
+    int alive = 0;
+
+    memset(bits, 0, ((size_t)count + 7) / 8);
+
+    for (int x = 0; x < count; x++)
+    {
+        int cell = row[x] & CELL_ALIVE;
+
+        bits[x >> 3] |= cell << (x & 7);
+        alive += cell;
+    }
+
+    return alive;
+}
+
+static void byte_clear(engine* e)
+{
+    byte_engine* b = (byte_engine*)e;
+    memset(b->cells, 0, b->stride * (e->height + 2));
+    b->counts.population = 0;
+}
+
+static void byte_set_wrap(engine* e, int wrap)
+{
+    // The border gets filled before every step anyway
+    e->wrap = wrap;
+}
+
+static void byte_set_rule(engine* e, const rule* r)
+{
+    byte_engine* b = (byte_engine*)e;
+
+    e->rule = *r;
+    b->kernel = byte_kernel_pick(r, NULL);
+}
+
+static int byte_take_census(engine* e, census* out)
+{
+    byte_engine* b = (byte_engine*)e;
+
+    // From now on every step counts what changed
+    if (!b->track_census)
+    {
+        b->counts.population = 0;
+        b->counts.births = 0;
+        b->counts.deaths = 0;
+
+        for (int y = 0; y < e->height; y++)
+        {
+            const uint8_t* row = byte_row(b, b->cells, y);
+
+            for (int x = 0; x < e->width; x++)
+            {
+                b->counts.population += row[x] & CELL_ALIVE;
+            }
+        }
+
+        b->track_census = 1;
+    }
+
+    *out = b->counts;
+    return 1;
+}
+
+static size_t byte_memory(engine* e)
+{
+    byte_engine* b = (byte_engine*)e;
+    size_t grid = b->stride * (e->height + 2);
+
+    return sizeof(byte_engine) + grid * 2 + b->bands * (sizeof(byte_changes) + 3 * b->stride);
+}
+
+static void byte_destroy(engine* e)
+{
+    byte_engine* b = (byte_engine*)e;
+    aligned_free(b->cells);
+    aligned_free(b->next);
+    free(b->band);
+    free(b->window);
+    free(b);
+}
+
+engine* byte_engine_create(int width, int height)
+{
+    byte_engine* b = calloc(1, sizeof(byte_engine));
+    if (!b)
+        return NULL;
+
+    b->stride = (size_t)width + 2;
+    b->cells = aligned_calloc(b->stride * (height + 2), sizeof(uint8_t));
+    b->next = aligned_calloc(b->stride * (height + 2), sizeof(uint8_t));
+
+    // There's always room for one band, so it can step even if there isn't
+    // enough memory for more threads
+    if (!b->cells || !b->next || !byte_fit_bands(b, 1))
+    {
+        byte_destroy((engine*)b);
+        return NULL;
+    }
+
+    b->base.rule = rule_life;
+    b->kernel = byte_kernel_pick(&b->base.rule, NULL);
+
+    b->base.name = "byte";
+    b->base.width = width;
+    b->base.height = height;
+    b->base.step = byte_step;
+    b->base.get_cell = byte_get_cell;
+    b->base.set_cell = byte_set_cell;
+    b->base.get_row = byte_get_row;
+    b->base.get_row_bits = byte_get_row_bits;
+    b->base.clear = byte_clear;
+    b->base.set_wrap = byte_set_wrap;
+    b->base.set_rule = byte_set_rule;
+    b->base.take_census = byte_take_census;
+    b->base.memory = byte_memory;
+    b->base.destroy = byte_destroy;
+
+    return (engine*)b;
+}
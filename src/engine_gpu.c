@@ -0,0 +1,375 @@
+/* engine_gpu.c - GPU engine
+ *
+ * The grid never leaves the GPU. It's two textures of one GL_R8UI texel
+ * per cell, and every generation is a fragment shader drawing the next one
+ * from the last one into the other texture, so there's a draw call per
+ * generation and nothing else. The window draws straight from whichever
+ * texture is the current one (see gpuview.h), so with this engine the CPU
+ * doesn't step or copy a single cell.
+ *
+ * The engine has a GL context of its own, on a hidden window, so it works
+ * the same headless. The window's renderer shares textures with it.
+ *
+ * Anything that does look at cells (drawing with the mouse, loading,
+ * saving, the history) goes through one row at a time. The row last used
+ * is kept around on the CPU, so setting or reading cells one after the
+ * other along a row is one download and one upload instead of one for
+ * every cell.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include "engine.h"
+#include "gl.h"
+
+typedef struct
+{
+    engine base;
+
+    SDL_Window* window;
+    SDL_GLContext context;
+
+    // The two generations, and a framebuffer to draw into each of them.
+    // textures[current] is the current one.
+    GLuint textures[2];
+    GLuint framebuffers[2];
+    int current;
+
+    GLuint program;
+    GLuint vertices;
+    GLint size_at;
+    GLint wrap_at;
+    GLint birth_at;
+    GLint survive_at;
+
+    // Row row_y of the grid, or -1 if there isn't one, and if it's been
+    // changed since it was last uploaded
+    uint8_t* row;
+    int row_y;
+    int row_changed;
+} gpu_engine;
+
+static const char* const step_shader =
+    "#version 130\n"
+    "uniform usampler2D cells;\n"
+    "uniform ivec2 size;\n"
+    "uniform int wrap;\n"
+    "uniform int birth;\n"
+    "uniform int survive;\n"
+    "out uint next;\n"
+    "void main()\n"
+    "{\n"
+    "    ivec2 cell = ivec2(gl_FragCoord.xy);\n"
+    "    int n = 0;\n"
+    "    for (int dy = -1; dy <= 1; dy++)\n"
+    "    {\n"
+    "        for (int dx = -1; dx <= 1; dx++)\n"
+    "        {\n"
+    "            ivec2 at = cell + ivec2(dx, dy);\n"
+    "            if (wrap != 0)\n"
+    "                at = (at + size) % size;\n"
+    "            else if (any(lessThan(at, ivec2(0))) || any(greaterThanEqual(at, size)))\n"
+    "                continue;\n"
+    "            n += int(texelFetch(cells, at, 0).r);\n"
+    "        }\n"
+    "    }\n"
+    "    uint alive = texelFetch(cells, cell, 0).r;\n"
+    "    n -= int(alive);\n"
+    "    next = uint(((alive != 0u ? survive : birth) >> n) & 1);\n"
+    "}\n";
+
+// Every call can come after the window's renderer made its own context
+// current, so they all switch back first
+static void use(gpu_engine* g)
+{
+    if (SDL_GL_GetCurrentContext() != g->context)
+        SDL_GL_MakeCurrent(g->window, g->context);
+}
+
+static void flush_row(gpu_engine* g)
+{
+    if (g->row_y < 0 || !g->row_changed)
+        return;
+
+    gl.PixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    gl.BindTexture(GL_TEXTURE_2D, g->textures[g->current]);
+    gl.TexSubImage2D(GL_TEXTURE_2D, 0, 0, g->row_y, g->base.width, 1, GL_RED_INTEGER, GL_UNSIGNED_BYTE, g->row);
+    g->row_changed = 0;
+}
+
+// Row y on the CPU, uploading the one before it if it changed
+static uint8_t* load_row(gpu_engine* g, int y)
+{
+    use(g);
+
+    if (g->row_y == y)
+        return g->row;
+
+    flush_row(g);
+
+    gl.PixelStorei(GL_PACK_ALIGNMENT, 1);
+    gl.BindFramebuffer(GL_FRAMEBUFFER, g->framebuffers[g->current]);
+    gl.ReadPixels(0, y, g->base.width, 1, GL_RED_INTEGER, GL_UNSIGNED_BYTE, g->row);
+    g->row_y = y;
+
+    return g->row;
+}
+
+static uint64_t gpu_advance(engine* e, uint64_t gens)
+{
+    gpu_engine* g = (gpu_engine*)e;
+
+    use(g);
+    flush_row(g);
+    g->row_y = -1;
+
+    gl.UseProgram(g->program);
+    gl.Uniform2i(g->size_at, e->width, e->height);
+    gl.Uniform1i(g->wrap_at, e->wrap);
+    gl.Uniform1i(g->birth_at, e->rule.birth);
+    gl.Uniform1i(g->survive_at, e->rule.survive);
+
+    gl.BindVertexArray(g->vertices);
+    gl.Viewport(0, 0, e->width, e->height);
+    gl.ActiveTexture(GL_TEXTURE0);
+
+    for (uint64_t i = 0; i < gens; i++)
+    {
+        gl.BindFramebuffer(GL_FRAMEBUFFER, g->framebuffers[!g->current]);
+        gl.BindTexture(GL_TEXTURE_2D, g->textures[g->current]);
+        gl.DrawArrays(GL_TRIANGLES, 0, 3);
+        g->current = !g->current;
+    }
+
+    // Drawing only queues it up. Waiting for it to be done means the time
+    // it took shows up where it was asked for, and the window's context
+    // sees the finished texture.
+    gl.Finish();
+
+    return gens;
+}
+
+static void gpu_step(engine* e)
+{
+    gpu_advance(e, 1);
+}
+
+static uint8_t gpu_get_cell(engine* e, int x, int y)
+{
+    return load_row((gpu_engine*)e, y)[x];
+}
+
+static void gpu_set_cell(engine* e, int x, int y, uint8_t alive)
+{
+    gpu_engine* g = (gpu_engine*)e;
+
+    load_row(g, y)[x] = alive ? 1 : 0;
+    g->row_changed = 1;
+}
+
+static void gpu_get_row(engine* e, int y, uint8_t* out)
+{
+    memcpy(out, load_row((gpu_engine*)e, y), e->width);
+}
+
+static void gpu_load_row_bits(engine* e, int y, const uint8_t* bits, int count)
+{
+    gpu_engine* g = (gpu_engine*)e;
+    uint8_t* row = load_row(g, y);
+
+    for (int x = 0; x < count; x++)
+    {
+        row[x] |= (bits[x >> 3] >> (x & 7)) & 1;
+    }
+
+    g->row_changed = 1;
+}
+
+static int gpu_get_row_bits(engine* e, int y, uint8_t* bits, int count)
+{
+    const uint8_t* row = load_row((gpu_engine*)e, y);
+    int alive = 0;
+
+    memset(bits, 0, ((size_t)count + 7) / 8);
+
+    for (int x = 0; x < count; x++)
+    {
+        bits[x >> 3] |= row[x] << (x & 7);
+        alive += row[x];
+    }
+
+    return alive;
+}
+
+static void gpu_clear(engine* e)
+{
+    gpu_engine* g = (gpu_engine*)e;
+    const GLuint dead[4] = { 0, 0, 0, 0 };
+
+    use(g);
+    g->row_y = -1;
+
+    gl.BindFramebuffer(GL_FRAMEBUFFER, g->framebuffers[g->current]);
+    gl.ClearBufferuiv(GL_COLOR, 0, dead);
+}
+
+static void gpu_set_wrap(engine* e, int wrap)
+{
+    // It's a uniform, set before every step
+    e->wrap = wrap;
+}
+
+static void gpu_set_rule(engine* e, const rule* r)
+{
+    e->rule = *r;
+}
+
+static unsigned int gpu_texture(engine* e)
+{
+    gpu_engine* g = (gpu_engine*)e;
+
+    use(g);
+    flush_row(g);
+    gl.Flush();
+
+    return g->textures[g->current];
+}
+
+static size_t gpu_memory(engine* e)
+{
+    // The textures are on the GPU, but they're still the grid
+    return sizeof(gpu_engine) + e->width + (size_t)e->width * e->height * 2;
+}
+
+static void gpu_destroy(engine* e)
+{
+    gpu_engine* g = (gpu_engine*)e;
+
+    if (g->context)
+    {
+        use(g);
+
+        if (gl.DeleteTextures)
+        {
+            gl.DeleteFramebuffers(2, g->framebuffers);
+            gl.DeleteTextures(2, g->textures);
+            gl.DeleteVertexArrays(1, &g->vertices);
+            gl.DeleteProgram(g->program);
+        }
+
+        SDL_GL_DeleteContext(g->context);
+    }
+
+    if (g->window)
+        SDL_DestroyWindow(g->window);
+
+    SDL_QuitSubSystem(SDL_INIT_VIDEO);
+
+    free(g->row);
+    free(g);
+}
+
+// The textures and everything to draw them with, returns 0 if the GPU
+// can't do it or doesn't have room for the grid
+static int gpu_setup(gpu_engine* g, int width, int height)
+{
+    if (!gl_load())
+        return 0;
+
+    GLint max_size = 0;
+    gl.GetIntegerv(GL_MAX_TEXTURE_SIZE, &max_size);
+
+    if (width > max_size || height > max_size)
+        return 0;
+
+    g->program = gl_program(gl_cover_shader, step_shader, "next");
+    if (!g->program)
+        return 0;
+
+    gl.UseProgram(g->program);
+    gl.Uniform1i(gl.GetUniformLocation(g->program, "cells"), 0);
+    g->size_at = gl.GetUniformLocation(g->program, "size");
+    g->wrap_at = gl.GetUniformLocation(g->program, "wrap");
+    g->birth_at = gl.GetUniformLocation(g->program, "birth");
+    g->survive_at = gl.GetUniformLocation(g->program, "survive");
+
+    gl.GenVertexArrays(1, &g->vertices);
+    gl.GenTextures(2, g->textures);
+    gl.GenFramebuffers(2, g->framebuffers);
+
+    const GLuint dead[4] = { 0, 0, 0, 0 };
+
+    for (int i = 0; i < 2; i++)
+    {
+        gl.BindTexture(GL_TEXTURE_2D, g->textures[i]);
+        gl.TexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        gl.TexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        gl.TexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        gl.TexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        gl.TexImage2D(GL_TEXTURE_2D, 0, GL_R8UI, width, height, 0, GL_RED_INTEGER, GL_UNSIGNED_BYTE, NULL);
+
+        gl.BindFramebuffer(GL_FRAMEBUFFER, g->framebuffers[i]);
+        gl.FramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, g->textures[i], 0);
+
+        if (gl.CheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+            return 0;
+
+        gl.ClearBufferuiv(GL_COLOR, 0, dead);
+    }
+
+    // Running out of memory for the textures only shows up here
+    return gl.GetError() == GL_NO_ERROR;
+}
+
+engine* gpu_engine_create(int width, int height)
+{
+    gpu_engine* g = calloc(1, sizeof(gpu_engine));
+    if (!g)
+        return NULL;
+
+    if (SDL_InitSubSystem(SDL_INIT_VIDEO) != 0)
+    {
+        free(g);
+        return NULL;
+    }
+
+    g->row = malloc(width);
+    g->row_y = -1;
+
+    // Texture sharing with the window's renderer is between
+    // compatibility contexts, so only the version gets asked for
+    SDL_GL_SetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, 3);
+    SDL_GL_SetAttribute(SDL_GL_CONTEXT_MINOR_VERSION, 0);
+
+    g->window = SDL_CreateWindow("Game of Life GPU", SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED, 1, 1, SDL_WINDOW_OPENGL | SDL_WINDOW_HIDDEN);
+    g->context = g->window ? SDL_GL_CreateContext(g->window) : NULL;
+
+    SDL_GL_ResetAttributes();
+
+    if (!g->row || !g->context || !gpu_setup(g, width, height))
+    {
+        gpu_destroy((engine*)g);
+        return NULL;
+    }
+
+    g->base.rule = rule_life;
+
+    g->base.name = "gpu";
+    g->base.width = width;
+    g->base.height = height;
+    g->base.step = gpu_step;
+    g->base.advance = gpu_advance;
+    g->base.get_cell = gpu_get_cell;
+    g->base.set_cell = gpu_set_cell;
+    g->base.get_row = gpu_get_row;
+    g->base.load_row_bits = gpu_load_row_bits;
+    g->base.get_row_bits = gpu_get_row_bits;
+    g->base.clear = gpu_clear;
+    g->base.set_wrap = gpu_set_wrap;
+    g->base.set_rule = gpu_set_rule;
+    g->base.texture = gpu_texture;
+    g->base.memory = gpu_memory;
+    g->base.destroy = gpu_destroy;
+
+    return (engine*)g;
+}
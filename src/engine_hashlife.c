@@ -0,0 +1,808 @@
+/* engine_hashlife.c - Hashlife engine
+ *
+ * Bill Gosper's Hashlife. The universe is a quadtree: a node of level k is
+ * a 2^k x 2^k square made of four level k-1 nodes, down to single cells at
+ * level 0. Every node is hash-consed, so any two squares that look the same
+ * are the same node in memory, no matter where or when they show up.
+ *
+ * The trick is that the center half of a level k node can be worked out
+ * 2^(k-2) generations ahead using only what's inside it, so the result gets
+ * stored on the node itself. Repeating patterns (which is most patterns
+ * after a while) only ever get computed once, and the simulation can jump
+ * ahead by huge powers of two in one go.
+ *
+ * Unlike the other engines the universe here has no edges: the grid is just
+ * the part of an unbounded plane that gets drawn and saved. Gliders that
+ * leave the grid keep going instead of dying at the edge.
+ *
+ * Running out of memory for a node can happen anywhere deep down in the
+ * recursion, so find_node() jumps straight back out to whoever called into
+ * the tree (see bail below). Nothing is ever changed in place until it's
+ * done, so the universe is still the one from before.
+*/
+
+#include <setjmp.h>
+#include <stdlib.h>
+#include <string.h>
+#include "engine.h"
+
+// Nodes are allocated in blocks of this many
+#define NODE_BLOCK 65536
+
+// Once there are this many nodes, anything the universe doesn't use anymore
+// (and every stored result) gets thrown away before the next step
+#define MAX_NODES (1 << 23)
+
+// Deepest tree we ever build, 2^62 cells across is plenty
+#define MAX_LEVEL 62
+
+// Biggest jump in one go. The root has to be 3 levels above it, and gets
+// expanded once more to step, which has to stay within MAX_LEVEL.
+#define MAX_STEP (MAX_LEVEL - 4)
+
+typedef struct node node;
+
+struct node
+{
+    // Quadrants, all NULL for the two level 0 nodes
+    node* nw;
+    node* ne;
+    node* sw;
+    node* se;
+
+    // The center half of this node, 2^result_step generations ahead
+    node* result;
+
+    // Next node in the same hash table bucket, or in the free list
+    node* next;
+
+    uint64_t population;
+    uint8_t level;
+    int8_t result_step;
+    uint8_t marked;
+};
+
+typedef struct node_block node_block;
+
+struct node_block
+{
+    node nodes[NODE_BLOCK];
+    node_block* next;
+};
+
+typedef struct
+{
+    engine base;
+
+    // Hash table of every node above level 0
+    node** table;
+    size_t table_size;
+    size_t count;
+
+    node_block* blocks;
+    node* free_list;
+
+    // The two level 0 nodes
+    node dead;
+    node alive;
+
+    // Empty node of every level, made as they are needed
+    node* empty[MAX_LEVEL + 1];
+
+    // The whole universe. Its center is where the middle of the grid is.
+    node* root;
+
+    // Where find_node() jumps to when there's no memory for a new node, set
+    // by everything that makes nodes for as long as it's making them
+    jmp_buf* bail;
+
+    // Grid cell (x, y) is (x - origin_x, y - origin_y) in the universe
+    int origin_x;
+    int origin_y;
+
+    // Level 2 nodes as 16 bits (row by row, top left in bit 15) to their
+    // center 2x2 one generation later (bit 3 is the top left), for the
+    // current rule
+    uint8_t life_4x4[65536];
+} hashlife;
+
+static size_t node_hash(const node* nw, const node* ne, const node* sw, const node* se)
+{
+    size_t h = (size_t)nw * 0x9E3779B1u + (size_t)ne * 0x85EBCA77u + (size_t)sw * 0xC2B2AE3Du + (size_t)se * 0x27D4EB2Fu;
+    return h ^ (h >> 16);
+}
+
+static node* alloc_node(hashlife* hl)
+{
+    if (!hl->free_list)
+    {
+        node_block* block = malloc(sizeof(node_block));
+        if (!block)
+            return NULL;
+
+        block->next = hl->blocks;
+        hl->blocks = block;
+
+        for (int i = 0; i < NODE_BLOCK; i++)
+        {
+            block->nodes[i].next = hl->free_list;
+            hl->free_list = &block->nodes[i];
+        }
+    }
+
+    node* n = hl->free_list;
+    hl->free_list = n->next;
+    return n;
+}
+
+static void grow_table(hashlife* hl)
+{
+    size_t size = hl->table_size * 2;
+    node** table = calloc(size, sizeof(node*));
+    if (!table)
+        return;
+
+    for (size_t i = 0; i < hl->table_size; i++)
+    {
+        node* n = hl->table[i];
+
+        while (n)
+        {
+            node* next = n->next;
+            size_t bucket = node_hash(n->nw, n->ne, n->sw, n->se) & (size - 1);
+
+            n->next = table[bucket];
+            table[bucket] = n;
+            n = next;
+        }
+    }
+
+    free(hl->table);
+    hl->table = table;
+    hl->table_size = size;
+}
+
+// Get the one node made of these four quadrants, making it if it's new
+static node* find_node(hashlife* hl, node* nw, node* ne, node* sw, node* se)
+{
+    size_t bucket = node_hash(nw, ne, sw, se) & (hl->table_size - 1);
+
+    for (node* n = hl->table[bucket]; n; n = n->next)
+    {
+        if (n->nw == nw && n->ne == ne && n->sw == sw && n->se == se)
+            return n;
+    }
+
+    node* n = alloc_node(hl);
+    if (!n)
+        longjmp(*hl->bail, 1);
+
+    n->nw = nw;
+    n->ne = ne;
+    n->sw = sw;
+    n->se = se;
+    n->result = NULL;
+    n->result_step = -1;
+    n->marked = 0;
+    n->level = nw->level + 1;
+    n->population = nw->population + ne->population + sw->population + se->population;
+
+    n->next = hl->table[bucket];
+    hl->table[bucket] = n;
+
+    if (++hl->count > hl->table_size)
+        grow_table(hl);
+
+    return n;
+}
+
+static node* empty_node(hashlife* hl, int level)
+{
+    if (level == 0)
+        return &hl->dead;
+
+    if (!hl->empty[level])
+    {
+        node* e = empty_node(hl, level - 1);
+        hl->empty[level] = find_node(hl, e, e, e, e);
+    }
+
+    return hl->empty[level];
+}
+
+// Put n in the middle of a node twice as big
+static node* expand(hashlife* hl, node* n)
+{
+    node* e = empty_node(hl, n->level - 1);
+
+    return find_node(hl,
+        find_node(hl, e, e, e, n->nw),
+        find_node(hl, e, e, n->ne, e),
+        find_node(hl, e, n->sw, e, e),
+        find_node(hl, n->se, e, e, e));
+}
+
+// The middle half of a node, as it is right now
+static node* centre(hashlife* hl, node* n)
+{
+    return find_node(hl, n->nw->se, n->ne->sw, n->sw->ne, n->se->nw);
+}
+
+// Is everything alive in the middle half of n?
+static int is_centered(const node* n)
+{
+    uint64_t inner = n->nw->se->population + n->ne->sw->population + n->sw->ne->population + n->se->nw->population;
+    return inner == n->population;
+}
+
+static int leaf_bits(const node* n)
+{
+    // A level 1 node as 4 bits, top left in bit 3
+    return (int)((n->nw->population << 3) | (n->ne->population << 2) | (n->sw->population << 1) | n->se->population);
+}
+
+// Level 2 base case, one generation with the lookup table
+static node* life_4x4(hashlife* hl, node* n)
+{
+    int nw = leaf_bits(n->nw), ne = leaf_bits(n->ne), sw = leaf_bits(n->sw), se = leaf_bits(n->se);
+
+    // Row by row, 4 bits per row for the 4x4 square
+    int bits = ((nw >> 2) << 14) | ((ne >> 2) << 12) |
+               ((nw & 3) << 10) | ((ne & 3) << 8) |
+               ((sw >> 2) << 6) | ((se >> 2) << 4) |
+               ((sw & 3) << 2) | (se & 3);
+
+    int result = hl->life_4x4[bits];
+
+    return find_node(hl,
+        result & 8 ? &hl->alive : &hl->dead,
+        result & 4 ? &hl->alive : &hl->dead,
+        result & 2 ? &hl->alive : &hl->dead,
+        result & 1 ? &hl->alive : &hl->dead);
+}
+
+// The center half of n, 2^step generations ahead. A node can only look
+// 2^(level - 2) generations ahead, so bigger steps get cut down to that.
+static node* successor(hashlife* hl, node* n, int step)
+{
+    if (step > n->level - 2)
+        step = n->level - 2;
+
+    if (n->population == 0)
+        return empty_node(hl, n->level - 1);
+
+    if (n->result && n->result_step == step)
+        return n->result;
+
+    node* result;
+
+    if (n->level == 2)
+    {
+        result = life_4x4(hl, n);
+    }
+    else
+    {
+        // Nine overlapping squares half the size of n, moved ahead by up to
+        // half of the generations
+        node* c1 = successor(hl, n->nw, step);
+        node* c2 = successor(hl, find_node(hl, n->nw->ne, n->ne->nw, n->nw->se, n->ne->sw), step);
+        node* c3 = successor(hl, n->ne, step);
+        node* c4 = successor(hl, find_node(hl, n->nw->sw, n->nw->se, n->sw->nw, n->sw->ne), step);
+        node* c5 = successor(hl, find_node(hl, n->nw->se, n->ne->sw, n->sw->ne, n->se->nw), step);
+        node* c6 = successor(hl, find_node(hl, n->ne->sw, n->ne->se, n->se->nw, n->se->ne), step);
+        node* c7 = successor(hl, n->sw, step);
+        node* c8 = successor(hl, find_node(hl, n->sw->ne, n->se->nw, n->sw->se, n->se->sw), step);
+        node* c9 = successor(hl, n->se, step);
+
+        if (step < n->level - 2)
+        {
+            // The first half already went far enough, so the four quarters
+            // of the result are just the middles
+            result = find_node(hl,
+                centre(hl, find_node(hl, c1, c2, c4, c5)),
+                centre(hl, find_node(hl, c2, c3, c5, c6)),
+                centre(hl, find_node(hl, c4, c5, c7, c8)),
+                centre(hl, find_node(hl, c5, c6, c8, c9)));
+        }
+        else
+        {
+            // Move the four quarters ahead by the other half
+            result = find_node(hl,
+                successor(hl, find_node(hl, c1, c2, c4, c5), step),
+                successor(hl, find_node(hl, c2, c3, c5, c6), step),
+                successor(hl, find_node(hl, c4, c5, c7, c8), step),
+                successor(hl, find_node(hl, c5, c6, c8, c9), step));
+        }
+    }
+
+    n->result = result;
+    n->result_step = (int8_t)step;
+    return result;
+}
+
+static void mark(node* n)
+{
+    if (n->level == 0 || n->marked)
+        return;
+
+    n->marked = 1;
+    mark(n->nw);
+    mark(n->ne);
+    mark(n->sw);
+    mark(n->se);
+}
+
+// Throw away every node the universe doesn't use anymore. Stored results
+// can point at nodes that get thrown away, so they all get forgotten too.
+static void collect(hashlife* hl)
+{
+    mark(hl->root);
+
+    for (int level = 1; level <= MAX_LEVEL; level++)
+    {
+        if (hl->empty[level])
+            mark(hl->empty[level]);
+    }
+
+    for (size_t i = 0; i < hl->table_size; i++)
+    {
+        node** link = &hl->table[i];
+
+        while (*link)
+        {
+            node* n = *link;
+
+            if (n->marked)
+            {
+                n->marked = 0;
+                n->result = NULL;
+                n->result_step = -1;
+                link = &n->next;
+            }
+            else
+            {
+                *link = n->next;
+                n->next = hl->free_list;
+                hl->free_list = n;
+                hl->count--;
+            }
+        }
+    }
+}
+
+// Move the universe ahead by 2^step generations
+static void advance_pow2(hashlife* hl, int step)
+{
+    if (hl->count > MAX_NODES)
+        collect(hl);
+
+    // Make the universe big enough that nothing falls off the edge of the
+    // result, which is only the middle half of the root. Everything alive
+    // has to end up in the middle quarter, and the generations being stepped
+    // can't let anything travel further than another quarter.
+    while (hl->root->level < step + 3 || !is_centered(hl->root))
+    {
+        // It can't get any bigger, so whatever is past the middle half is
+        // dropped instead. That's over 2^59 cells away from the grid, so it
+        // was never coming back.
+        if (hl->root->level >= MAX_LEVEL - 1)
+        {
+            hl->root = expand(hl, centre(hl, hl->root));
+            break;
+        }
+
+        hl->root = expand(hl, hl->root);
+    }
+
+    hl->root = successor(hl, expand(hl, hl->root), step);
+}
+
+// After running out of memory: the nodes the failed step got to make
+// aren't in the universe, so throw them out along with the stored results
+// to have some room again
+static void give_up(hashlife* hl)
+{
+    hl->bail = NULL;
+    hl->base.out_of_memory = 1;
+    collect(hl);
+}
+
+static uint64_t hashlife_advance(engine* e, uint64_t gens)
+{
+    hashlife* hl = (hashlife*)e;
+    jmp_buf bail;
+
+    // Still needed after the jump back, so it can't live in a register
+    volatile uint64_t done = 0;
+
+    if (setjmp(bail))
+    {
+        give_up(hl);
+        return done;
+    }
+
+    hl->bail = &bail;
+
+    uint64_t left = gens;
+
+    for (int step = 0; left != 0 && step < MAX_STEP; step++, left >>= 1)
+    {
+        if (left & 1)
+        {
+            advance_pow2(hl, step);
+            done += (uint64_t)1 << step;
+        }
+    }
+
+    // Whatever is left goes in jumps of 2^MAX_STEP, at most 63 of them
+    for (; left != 0; left--)
+    {
+        advance_pow2(hl, MAX_STEP);
+        done += (uint64_t)1 << MAX_STEP;
+    }
+
+    hl->bail = NULL;
+    return gens;
+}
+
+static void hashlife_step(engine* e)
+{
+    hashlife_advance(e, 1);
+}
+
+// Make the universe big enough to hold universe coordinate (x, y)
+static void fit(hashlife* hl, int64_t x, int64_t y)
+{
+    while (1)
+    {
+        int64_t half = (int64_t)1 << (hl->root->level - 1);
+
+        if (x >= -half && x < half && y >= -half && y < half)
+            return;
+
+        hl->root = expand(hl, hl->root);
+    }
+}
+
+// Copy of n with the cell at (x, y) set, relative to n's top left corner
+static node* set_node(hashlife* hl, node* n, int64_t x, int64_t y, int alive)
+{
+    if (n->level == 0)
+        return alive ? &hl->alive : &hl->dead;
+
+    int64_t half = (int64_t)1 << (n->level - 1);
+    node* nw = n->nw, * ne = n->ne, * sw = n->sw, * se = n->se;
+
+    if (y < half)
+    {
+        if (x < half)
+            nw = set_node(hl, nw, x, y, alive);
+        else
+            ne = set_node(hl, ne, x - half, y, alive);
+    }
+    else
+    {
+        if (x < half)
+            sw = set_node(hl, sw, x, y - half, alive);
+        else
+            se = set_node(hl, se, x - half, y - half, alive);
+    }
+
+    return find_node(hl, nw, ne, sw, se);
+}
+
+static uint8_t get_node(const node* n, int64_t x, int64_t y)
+{
+    while (n->level > 0)
+    {
+        if (n->population == 0)
+            return 0;
+
+        int64_t half = (int64_t)1 << (n->level - 1);
+
+        if (y < half)
+        {
+            n = x < half ? n->nw : n->ne;
+        }
+        else
+        {
+            n = x < half ? n->sw : n->se;
+            y -= half;
+        }
+
+        if (x >= half)
+            x -= half;
+    }
+
+    return (uint8_t)n->population;
+}
+
+// Fill in the live cells of row y (relative to n's top left corner at
+// (nx, 0)) into out, which covers universe columns [x0, x0 + width)
+static void fill_row(const node* n, int64_t nx, int64_t y, int64_t x0, int width, uint8_t* out)
+{
+    if (n->population == 0)
+        return;
+
+    int64_t size = (int64_t)1 << n->level;
+
+    if (nx >= x0 + width || nx + size <= x0)
+        return;
+
+    if (n->level == 0)
+    {
+        out[nx - x0] = 1;
+        return;
+    }
+
+    int64_t half = size >> 1;
+
+    if (y < half)
+    {
+        fill_row(n->nw, nx, y, x0, width, out);
+        fill_row(n->ne, nx + half, y, x0, width, out);
+    }
+    else
+    {
+        fill_row(n->sw, nx, y - half, x0, width, out);
+        fill_row(n->se, nx + half, y - half, x0, width, out);
+    }
+}
+
+// Add the live cells of n (top left corner at (nx, ny)) to the blocks of
+// 2^shift cells that it overlaps, out of the row of count of them starting
+// at (x0, y0). Nodes that fit in one block don't have to be looked into.
+static void count_node(const node* n, int64_t nx, int64_t ny, int64_t x0, int64_t y0, int shift, int count, uint32_t* out)
+{
+    if (n->population == 0)
+        return;
+
+    int64_t size = (int64_t)1 << n->level;
+    int64_t block = (int64_t)1 << shift;
+
+    if (nx >= x0 + count * block || nx + size <= x0 || ny >= y0 + block || ny + size <= y0)
+        return;
+
+    if (nx >= x0 && ny >= y0 && ny + size <= y0 + block && (nx - x0) >> shift == (nx + size - 1 - x0) >> shift)
+    {
+        out[(nx - x0) >> shift] += (uint32_t)n->population;
+        return;
+    }
+
+    int64_t half = size >> 1;
+
+    count_node(n->nw, nx, ny, x0, y0, shift, count, out);
+    count_node(n->ne, nx + half, ny, x0, y0, shift, count, out);
+    count_node(n->sw, nx, ny + half, x0, y0, shift, count, out);
+    count_node(n->se, nx + half, ny + half, x0, y0, shift, count, out);
+}
+
+static void hashlife_count_blocks(engine* e, int shift, int bx, int by, int count, uint32_t* out)
+{
+    hashlife* hl = (hashlife*)e;
+    int64_t half = (int64_t)1 << (hl->root->level - 1);
+    int64_t size = (int64_t)1 << shift;
+
+    count_node(hl->root, -half, -half, bx * size - hl->origin_x, by * size - hl->origin_y, shift, count, out);
+}
+
+static uint8_t hashlife_get_cell(engine* e, int x, int y)
+{
+    hashlife* hl = (hashlife*)e;
+    int64_t half = (int64_t)1 << (hl->root->level - 1);
+    int64_t ux = (int64_t)x - hl->origin_x;
+    int64_t uy = (int64_t)y - hl->origin_y;
+
+    if (ux < -half || ux >= half || uy < -half || uy >= half)
+        return 0;
+
+    return get_node(hl->root, ux + half, uy + half);
+}
+
+static void hashlife_set_cell(engine* e, int x, int y, uint8_t alive)
+{
+    hashlife* hl = (hashlife*)e;
+    int64_t ux = (int64_t)x - hl->origin_x;
+    int64_t uy = (int64_t)y - hl->origin_y;
+    jmp_buf bail;
+
+    if (setjmp(bail))
+    {
+        give_up(hl);
+        return;
+    }
+
+    hl->bail = &bail;
+
+    fit(hl, ux, uy);
+
+    int64_t half = (int64_t)1 << (hl->root->level - 1);
+    hl->root = set_node(hl, hl->root, ux + half, uy + half, alive);
+
+    hl->bail = NULL;
+}
+
+static void hashlife_get_row(engine* e, int y, uint8_t* out)
+{
+    hashlife* hl = (hashlife*)e;
+    int64_t half = (int64_t)1 << (hl->root->level - 1);
+    int64_t uy = (int64_t)y - hl->origin_y;
+
+    memset(out, 0, e->width);
+
+    if (uy >= -half && uy < half)
+        fill_row(hl->root, -half, uy + half, -(int64_t)hl->origin_x, e->width, out);
+}
+
+// Forget every node and free their memory, except for the last block if
+// keep is set, which all goes back on the free list
+static void free_nodes(hashlife* hl, int keep)
+{
+    while (hl->blocks && (!keep || hl->blocks->next))
+    {
+        node_block* next = hl->blocks->next;
+        free(hl->blocks);
+        hl->blocks = next;
+    }
+
+    hl->free_list = NULL;
+
+    for (int i = 0; hl->blocks && i < NODE_BLOCK; i++)
+    {
+        hl->blocks->nodes[i].next = hl->free_list;
+        hl->free_list = &hl->blocks->nodes[i];
+    }
+
+    hl->count = 0;
+    memset(hl->table, 0, hl->table_size * sizeof(node*));
+    memset(hl->empty, 0, sizeof(hl->empty));
+}
+
+static void hashlife_clear(engine* e)
+{
+    hashlife* hl = (hashlife*)e;
+
+    // One block is far more than the empty root needs, so this can't run
+    // out of memory
+    free_nodes(hl, 1);
+
+    // Start out just big enough to hold the whole grid
+    int size = e->width > e->height ? e->width : e->height;
+    int level = 3;
+
+    while (((int64_t)1 << (level - 1)) < size)
+        level++;
+
+    hl->root = empty_node(hl, level);
+}
+
+// The root knows how many cells are alive, but a jump of a lot of
+// generations at once never sees any of them being born or dying
+static int hashlife_take_census(engine* e, census* out)
+{
+    hashlife* hl = (hashlife*)e;
+
+    out->population = hl->root->population;
+    out->births = 0;
+    out->deaths = 0;
+    return 0;
+}
+
+static size_t hashlife_memory(engine* e)
+{
+    hashlife* hl = (hashlife*)e;
+    size_t blocks = 0;
+
+    for (node_block* block = hl->blocks; block; block = block->next)
+        blocks++;
+
+    return sizeof(hashlife) + blocks * sizeof(node_block) + hl->table_size * sizeof(node*);
+}
+
+static void hashlife_destroy(engine* e)
+{
+    hashlife* hl = (hashlife*)e;
+
+    free_nodes(hl, 0);
+    free(hl->table);
+    free(hl);
+}
+
+// Work out the center 2x2 of every 4x4 square one generation later
+static void build_table(hashlife* hl, const rule* r)
+{
+    for (int bits = 0; bits < 65536; bits++)
+    {
+        int result = 0;
+
+        for (int cy = 1; cy <= 2; cy++)
+        {
+            for (int cx = 1; cx <= 2; cx++)
+            {
+                int live_neighbors = 0;
+
+                for (int dy = -1; dy <= 1; dy++)
+                {
+                    for (int dx = -1; dx <= 1; dx++)
+                    {
+                        if ((dx || dy) && (bits >> (15 - ((cy + dy) * 4 + cx + dx)) & 1))
+                            live_neighbors++;
+                    }
+                }
+
+                int alive = bits >> (15 - (cy * 4 + cx)) & 1;
+
+                if (rule_next(r->birth, r->survive, alive, live_neighbors))
+                    result |= 1 << (3 - ((cy - 1) * 2 + (cx - 1)));
+            }
+        }
+
+        hl->life_4x4[bits] = (uint8_t)result;
+    }
+}
+
+// Every stored result is for the old rule, so they all get forgotten. The
+// nodes themselves are just cells and stay.
+static void hashlife_set_rule(engine* e, const rule* r)
+{
+    hashlife* hl = (hashlife*)e;
+
+    e->rule = *r;
+    build_table(hl, r);
+
+    for (size_t i = 0; i < hl->table_size; i++)
+    {
+        for (node* n = hl->table[i]; n; n = n->next)
+        {
+            n->result = NULL;
+            n->result_step = -1;
+        }
+    }
+}
+
+engine* hashlife_engine_create(int width, int height)
+{
+    hashlife* hl = calloc(1, sizeof(hashlife));
+    if (!hl)
+        return NULL;
+
+    hl->table_size = 1 << 16;
+    hl->table = calloc(hl->table_size, sizeof(node*));
+    hl->blocks = calloc(1, sizeof(node_block));
+
+    if (!hl->table || !hl->blocks)
+    {
+        free(hl->table);
+        free(hl->blocks);
+        free(hl);
+        return NULL;
+    }
+
+    hl->alive.population = 1;
+
+    hl->origin_x = width / 2;
+    hl->origin_y = height / 2;
+
+    hl->base.rule = rule_life;
+    build_table(hl, &hl->base.rule);
+
+    hl->base.name = "hashlife";
+    hl->base.width = width;
+    hl->base.height = height;
+    hl->base.unbounded = 1;
+    hl->base.step = hashlife_step;
+    hl->base.advance = hashlife_advance;
+    hl->base.get_cell = hashlife_get_cell;
+    hl->base.set_cell = hashlife_set_cell;
+    hl->base.get_row = hashlife_get_row;
+    hl->base.count_blocks = hashlife_count_blocks;
+    hl->base.clear = hashlife_clear;
+    hl->base.set_rule = hashlife_set_rule;
+    hl->base.take_census = hashlife_take_census;
+    hl->base.memory = hashlife_memory;
+    hl->base.destroy = hashlife_destroy;
+
+    hashlife_clear(&hl->base);
+
+    return (engine*)hl;
+}
@@ -0,0 +1,555 @@
+/* engine_sparse.c - Sparse engine
+ *
+ * Only live cells are stored, as a hash set of their coordinates. To step,
+ * every live cell adds one to the neighbor count of each of the 8 cells
+ * around it (kept in a second hash table), and then every cell that ended
+ * up with a count gets the rule applied to it. Cells with no live neighbors
+ * never come up at all, so memory and time only depend on how many cells
+ * are alive, not how big the universe is.
+ *
+ * Like hashlife the universe has no edges, the grid is only the part of it
+ * that gets drawn and saved, with grid cell (x, y) at (x, y) in the
+ * universe. Coordinates are 32 bits and wrap around at 2^32, which nothing
+ * is ever going to get anywhere near.
+ *
+ * Anything that reads whole rows (drawing, saving) works from a sorted copy
+ * of the live cells, which is only made again once the cells have changed.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include "engine.h"
+#include "hash.h"
+
+// Marks a free slot. It's also the key of the cell at (2^31 - 1, 2^31 - 1),
+// which can never come to life because of it.
+#define EMPTY_KEY UINT64_MAX
+
+// Smallest table, always a power of two
+#define MIN_CAPACITY 64
+
+// The neighbor count of a cell, and whether it's alive, in one byte
+#define COUNT_ALIVE 0x10
+#define COUNT_MASK 0x0F
+
+// Open addressing hash table of cell keys, with a byte for every key if
+// values isn't NULL
+typedef struct
+{
+    uint64_t* keys;
+    uint8_t* values;
+    size_t capacity;
+    size_t count;
+} cell_table;
+
+typedef struct
+{
+    engine base;
+
+    // Every live cell
+    cell_table live;
+
+    // Neighbor counts while stepping, kept around so it doesn't have to be
+    // allocated every generation
+    cell_table counts;
+
+    // The live cells in row order, NULL or out of date if sorted_valid is 0
+    uint64_t* sorted;
+    size_t sorted_capacity;
+    int sorted_valid;
+
+    // Every step knows these anyway, so they're always counted
+    uint64_t births;
+    uint64_t deaths;
+} sparse_engine;
+
+// Rows sort before columns, and flipping the top bits makes negative
+// coordinates sort before positive ones
+static inline uint64_t cell_key(uint32_t x, uint32_t y)
+{
+    return ((uint64_t)(y ^ 0x80000000u) << 32) | (x ^ 0x80000000u);
+}
+
+static inline int32_t key_x(uint64_t key)
+{
+    return (int32_t)((uint32_t)key ^ 0x80000000u);
+}
+
+static inline int32_t key_y(uint64_t key)
+{
+    return (int32_t)((uint32_t)(key >> 32) ^ 0x80000000u);
+}
+
+static inline size_t slot_of(const cell_table* t, uint64_t key)
+{
+    return (size_t)hash_mix(key) & (t->capacity - 1);
+}
+
+static int table_init(cell_table* t, size_t capacity, int with_values)
+{
+    t->capacity = capacity;
+    t->count = 0;
+    t->keys = malloc(capacity * sizeof(uint64_t));
+    t->values = with_values ? calloc(capacity, sizeof(uint8_t)) : NULL;
+
+    if (!t->keys || (with_values && !t->values))
+    {
+        free(t->keys);
+        free(t->values);
+        t->keys = NULL;
+        t->values = NULL;
+        return 0;
+    }
+
+    memset(t->keys, 0xFF, capacity * sizeof(uint64_t));
+    return 1;
+}
+
+static void table_free(cell_table* t)
+{
+    free(t->keys);
+    free(t->values);
+    memset(t, 0, sizeof(cell_table));
+}
+
+// Empty it out without giving back any memory
+static void table_reset(cell_table* t)
+{
+    memset(t->keys, 0xFF, t->capacity * sizeof(uint64_t));
+
+    if (t->values)
+        memset(t->values, 0, t->capacity);
+
+    t->count = 0;
+}
+
+// Empty it out, and make it the right size for about expected keys. Tables
+// only grow while stepping, so after a big pattern dies down this is what
+// gets them small again.
+static void table_fit(cell_table* t, size_t expected)
+{
+    size_t capacity = MIN_CAPACITY;
+
+    while (capacity < expected * 2)
+        capacity *= 2;
+
+    if (t->capacity >= capacity && t->capacity <= capacity * 4)
+    {
+        table_reset(t);
+        return;
+    }
+
+    cell_table old = *t;
+
+    if (!table_init(t, capacity, old.values != NULL))
+    {
+        // Keep using the one we have
+        *t = old;
+        table_reset(t);
+        return;
+    }
+
+    table_free(&old);
+}
+
+// The slot holding key, or the free slot it would go in
+static inline size_t table_find(const cell_table* t, uint64_t key)
+{
+    size_t slot = slot_of(t, key);
+
+    while (t->keys[slot] != key && t->keys[slot] != EMPTY_KEY)
+        slot = (slot + 1) & (t->capacity - 1);
+
+    return slot;
+}
+
+static int table_insert(cell_table* t, uint64_t key, uint8_t value);
+
+// Twice as many slots once it's half full. Returns 0 and leaves the table
+// the way it was if there's no memory for that.
+static int table_grow(cell_table* t)
+{
+    cell_table old = *t;
+
+    if (!table_init(t, old.capacity * 2, old.values != NULL))
+    {
+        *t = old;
+        return 0;
+    }
+
+    // The new table is never even half full, so this never has to grow
+    for (size_t i = 0; i < old.capacity; i++)
+    {
+        if (old.keys[i] != EMPTY_KEY)
+            table_insert(t, old.keys[i], old.values ? old.values[i] : 0);
+    }
+
+    table_free(&old);
+    return 1;
+}
+
+// Returns 0 without putting key in if the table had to grow and couldn't
+static int table_insert(cell_table* t, uint64_t key, uint8_t value)
+{
+    if ((t->count + 1) * 2 > t->capacity && !table_grow(t))
+        return 0;
+
+    size_t slot = table_find(t, key);
+
+    if (t->keys[slot] == EMPTY_KEY)
+    {
+        t->keys[slot] = key;
+        t->count++;
+    }
+
+    if (t->values)
+        t->values[slot] = value;
+
+    return 1;
+}
+
+// Add to the value of key, putting it in the table first if it's new.
+// Returns 0 if it was new and there was no memory to grow for it.
+static inline int table_add(cell_table* t, uint64_t key, uint8_t amount)
+{
+    size_t slot = table_find(t, key);
+
+    if (t->keys[slot] == EMPTY_KEY)
+    {
+        if ((t->count + 1) * 2 > t->capacity)
+        {
+            if (!table_grow(t))
+                return 0;
+
+            slot = table_find(t, key);
+        }
+
+        t->keys[slot] = key;
+        t->count++;
+    }
+
+    t->values[slot] += amount;
+    return 1;
+}
+
+// Take key out, moving back any keys after it that would otherwise not be
+// found anymore
+static void table_remove(cell_table* t, uint64_t key)
+{
+    size_t mask = t->capacity - 1;
+    size_t hole = table_find(t, key);
+
+    if (t->keys[hole] == EMPTY_KEY)
+        return;
+
+    t->count--;
+
+    for (size_t slot = (hole + 1) & mask; t->keys[slot] != EMPTY_KEY; slot = (slot + 1) & mask)
+    {
+        // Keys that wanted a slot between the hole and here stay put
+        size_t home = slot_of(t, t->keys[slot]);
+
+        if (((slot - home) & mask) < ((slot - hole) & mask))
+            continue;
+
+        t->keys[hole] = t->keys[slot];
+        hole = slot;
+    }
+
+    t->keys[hole] = EMPTY_KEY;
+}
+
+// Ran out of memory halfway through filling in the next generation, so put
+// the last one back. Every cell of it is marked alive in the counts, and
+// the table still has at least the room it had for them before.
+static void restore_live(sparse_engine* s)
+{
+    table_reset(&s->live);
+
+    for (size_t i = 0; i < s->counts.capacity; i++)
+    {
+        if (s->counts.keys[i] != EMPTY_KEY && (s->counts.values[i] & COUNT_ALIVE))
+            table_insert(&s->live, s->counts.keys[i], 0);
+    }
+
+    s->base.out_of_memory = 1;
+}
+
+static void sparse_step(engine* e)
+{
+    sparse_engine* s = (sparse_engine*)e;
+    cell_table* live = &s->live;
+    cell_table* counts = &s->counts;
+
+    size_t population = live->count;
+
+    // Most live cells share most of their neighbors with other live cells
+    table_fit(counts, population * 4);
+
+    // Every live cell counts towards the 8 cells around it, and marks
+    // itself as alive
+    for (size_t i = 0; i < live->capacity; i++)
+    {
+        uint64_t key = live->keys[i];
+
+        if (key == EMPTY_KEY)
+            continue;
+
+        uint32_t x = (uint32_t)key_x(key);
+        uint32_t y = (uint32_t)key_y(key);
+
+        for (int dy = -1; dy <= 1; dy++)
+        {
+            for (int dx = -1; dx <= 1; dx++)
+            {
+                // Nothing happened to the live cells yet, so giving up
+                // here leaves them as they were
+                if (!table_add(counts, cell_key(x + (uint32_t)dx, y + (uint32_t)dy), dx || dy ? 1 : COUNT_ALIVE))
+                {
+                    e->out_of_memory = 1;
+                    return;
+                }
+            }
+        }
+    }
+
+    // Only cells next to a live one can be alive next generation
+    table_fit(live, population);
+
+    size_t births = 0;
+
+    for (size_t i = 0; i < counts->capacity; i++)
+    {
+        uint8_t value = counts->values[i];
+
+        if (counts->keys[i] == EMPTY_KEY)
+            continue;
+
+        if (!rule_next(e->rule.birth, e->rule.survive, (value & COUNT_ALIVE) != 0, value & COUNT_MASK))
+            continue;
+
+        if (!table_insert(live, counts->keys[i], 0))
+        {
+            restore_live(s);
+            return;
+        }
+
+        births += !(value & COUNT_ALIVE);
+    }
+
+    // Everything else that was alive died
+    s->births += births;
+    s->deaths += population - (live->count - births);
+    s->sorted_valid = 0;
+}
+
+static uint8_t sparse_get_cell(engine* e, int x, int y)
+{
+    sparse_engine* s = (sparse_engine*)e;
+    return s->live.keys[table_find(&s->live, cell_key((uint32_t)x, (uint32_t)y))] != EMPTY_KEY;
+}
+
+static void sparse_set_cell(engine* e, int x, int y, uint8_t alive)
+{
+    sparse_engine* s = (sparse_engine*)e;
+    uint64_t key = cell_key((uint32_t)x, (uint32_t)y);
+
+    if (alive && !table_insert(&s->live, key, 0))
+        e->out_of_memory = 1;
+    else if (!alive)
+        table_remove(&s->live, key);
+
+    s->sorted_valid = 0;
+}
+
+static int compare_keys(const void* a, const void* b)
+{
+    uint64_t ka = *(const uint64_t*)a;
+    uint64_t kb = *(const uint64_t*)b;
+
+    return ka < kb ? -1 : ka > kb;
+}
+
+// Put every live cell in order, row by row
+static int sort_cells(sparse_engine* s)
+{
+    if (s->sorted_valid)
+        return 1;
+
+    if (s->sorted_capacity < s->live.count)
+    {
+        uint64_t* sorted = realloc(s->sorted, s->live.count * sizeof(uint64_t));
+        if (!sorted)
+            return 0;
+
+        s->sorted = sorted;
+        s->sorted_capacity = s->live.count;
+    }
+
+    size_t count = 0;
+
+    for (size_t i = 0; i < s->live.capacity; i++)
+    {
+        if (s->live.keys[i] != EMPTY_KEY)
+            s->sorted[count++] = s->live.keys[i];
+    }
+
+    if (count > 0)
+        qsort(s->sorted, count, sizeof(uint64_t), compare_keys);
+    s->sorted_valid = 1;
+    return 1;
+}
+
+// Index of the first sorted cell at or after key
+static size_t lower_bound(const sparse_engine* s, uint64_t key)
+{
+    size_t low = 0;
+    size_t high = s->live.count;
+
+    while (low < high)
+    {
+        size_t middle = low + (high - low) / 2;
+
+        if (s->sorted[middle] < key)
+            low = middle + 1;
+        else
+            high = middle;
+    }
+
+    return low;
+}
+
+static void sparse_get_row(engine* e, int y, uint8_t* out)
+{
+    sparse_engine* s = (sparse_engine*)e;
+
+    memset(out, 0, e->width);
+
+    if (!sort_cells(s))
+    {
+        // Out of memory, so look up every cell instead
+        for (int x = 0; x < e->width; x++)
+            out[x] = sparse_get_cell(e, x, y);
+
+        return;
+    }
+
+    for (size_t i = lower_bound(s, cell_key(0, (uint32_t)y)); i < s->live.count && key_y(s->sorted[i]) == y && key_x(s->sorted[i]) < e->width; i++)
+    {
+        out[key_x(s->sorted[i])] = 1;
+    }
+}
+
+// Goes through the sorted cells of every row the blocks cover, jumping
+// over the parts of the rows left and right of them
+static void sparse_count_blocks(engine* e, int shift, int bx, int by, int count, uint32_t* out)
+{
+    sparse_engine* s = (sparse_engine*)e;
+
+    if (!sort_cells(s))
+        return;
+
+    int64_t size = (int64_t)1 << shift;
+    int64_t x0 = bx * size;
+    int64_t x_end = x0 + count * size;
+    int64_t y_end = (by + 1) * size;
+
+    size_t i = lower_bound(s, cell_key((uint32_t)x0, (uint32_t)(by * size)));
+
+    while (i < s->live.count)
+    {
+        int64_t x = key_x(s->sorted[i]);
+        int64_t y = key_y(s->sorted[i]);
+
+        if (y >= y_end)
+            break;
+
+        if (x < x0)
+        {
+            i = lower_bound(s, cell_key((uint32_t)x0, (uint32_t)y));
+        }
+        else if (x >= x_end)
+        {
+            i = lower_bound(s, cell_key((uint32_t)x0, (uint32_t)(y + 1)));
+        }
+        else
+        {
+            out[(x - x0) >> shift]++;
+            i++;
+        }
+    }
+}
+
+static void sparse_clear(engine* e)
+{
+    sparse_engine* s = (sparse_engine*)e;
+
+    table_fit(&s->live, 0);
+    s->sorted_valid = 0;
+}
+
+static int sparse_take_census(engine* e, census* out)
+{
+    sparse_engine* s = (sparse_engine*)e;
+
+    out->population = s->live.count;
+    out->births = s->births;
+    out->deaths = s->deaths;
+    return 1;
+}
+
+static void sparse_set_rule(engine* e, const rule* r)
+{
+    // The rule gets looked up for every cell anyway
+    e->rule = *r;
+}
+
+static size_t sparse_memory(engine* e)
+{
+    sparse_engine* s = (sparse_engine*)e;
+
+    return sizeof(sparse_engine) + s->live.capacity * sizeof(uint64_t)
+        + s->counts.capacity * (sizeof(uint64_t) + sizeof(uint8_t))
+        + s->sorted_capacity * sizeof(uint64_t);
+}
+
+static void sparse_destroy(engine* e)
+{
+    sparse_engine* s = (sparse_engine*)e;
+
+    table_free(&s->live);
+    table_free(&s->counts);
+    free(s->sorted);
+    free(s);
+}
+
+engine* sparse_engine_create(int width, int height)
+{
+    sparse_engine* s = calloc(1, sizeof(sparse_engine));
+    if (!s)
+        return NULL;
+
+    if (!table_init(&s->live, MIN_CAPACITY, 0) || !table_init(&s->counts, MIN_CAPACITY, 1))
+    {
+        sparse_destroy((engine*)s);
+        return NULL;
+    }
+
+    s->base.name = "sparse";
+    s->base.width = width;
+    s->base.height = height;
+    s->base.unbounded = 1;
+    s->base.rule = rule_life;
+    s->base.step = sparse_step;
+    s->base.get_cell = sparse_get_cell;
+    s->base.set_cell = sparse_set_cell;
+    s->base.get_row = sparse_get_row;
+    s->base.count_blocks = sparse_count_blocks;
+    s->base.clear = sparse_clear;
+    s->base.set_rule = sparse_set_rule;
+    s->base.take_census = sparse_take_census;
+    s->base.memory = sparse_memory;
+    s->base.destroy = sparse_destroy;
+
+    return (engine*)s;
+}
@@ -0,0 +1,277 @@
+/* ensemble.c - Running lots of random soups
+*/
+
+#include <SDL2/SDL.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "ensemble.h"
+#include "engine.h"
+#include "workers.h"
+#include "cycles.h"
+#include "soup.h"
+
+// Seeds [next, end) that a thread hasn't gotten to yet. The thread takes
+// them from the front and the others steal from the back.
+typedef struct
+{
+    SDL_SpinLock lock;
+    uint64_t next;
+    uint64_t end;
+} seed_queue;
+
+// What every thread has, made once before any soup runs
+typedef struct
+{
+    seed_queue queue;
+    engine* sim;
+    cycles* seen;
+} ensemble_job;
+
+typedef struct
+{
+    const options* opts;
+    ensemble_job* jobs;
+    int count;
+
+    // Only one thread writes a line at a time
+    SDL_mutex* writing;
+    FILE* out;
+
+    // How many soups settled down before --gens, only for the summary
+    uint64_t settled;
+} ensemble;
+
+// Next seed for job index, stealing half of another job's seeds once its
+// own are gone. Returns 0 when there's nothing left anywhere.
+static int take_seed(ensemble* en, int index, uint64_t* seed)
+{
+    seed_queue* own = &en->jobs[index].queue;
+
+    SDL_AtomicLock(&own->lock);
+    int found = own->next < own->end;
+    if (found)
+        *seed = own->next++;
+    SDL_AtomicUnlock(&own->lock);
+
+    if (found)
+        return 1;
+
+    // Only one lock is ever held at a time. Nobody steals from a queue
+    // that's empty, so it doesn't matter that ours is empty for a moment
+    // before the stolen seeds go in.
+    for (int i = 1; i < en->count; i++)
+    {
+        seed_queue* victim = &en->jobs[(index + i) % en->count].queue;
+        uint64_t start = 0, end = 0;
+
+        SDL_AtomicLock(&victim->lock);
+        if (victim->next < victim->end)
+        {
+            end = victim->end;
+            start = end - (end - victim->next + 1) / 2;
+            victim->end = start;
+        }
+        SDL_AtomicUnlock(&victim->lock);
+
+        if (start == end)
+            continue;
+
+        *seed = start;
+
+        SDL_AtomicLock(&own->lock);
+        own->next = start + 1;
+        own->end = end;
+        SDL_AtomicUnlock(&own->lock);
+
+        return 1;
+    }
+
+    return 0;
+}
+
+// Run one soup until it repeats itself or runs out of generations, and
+// write its line
+static void run_soup(ensemble* en, ensemble_job* job, uint64_t seed)
+{
+    const options* opts = en->opts;
+    engine* sim = job->sim;
+    uint64_t gens = (uint64_t)opts->gens;
+    uint64_t period = 0;
+    int settled = 0;
+
+    soup_fill(sim, seed, opts->density, 0, 0, sim->width, sim->height);
+    sim->generation = 0;
+
+    cycles_reset(job->seen);
+    cycles_check(job->seen, sim, &period);
+
+    while (sim->generation < gens && !settled)
+    {
+        engine_advance(sim, 1);
+        settled = cycles_check(job->seen, sim, &period);
+    }
+
+    unsigned long long population = (unsigned long long)engine_population(sim);
+
+    SDL_LockMutex(en->writing);
+
+    // The lifetime is the first generation of the cycle, the period is left
+    // empty if it never got there
+    if (settled)
+    {
+        fprintf(en->out, "%llu,%llu,%llu,%llu\n", (unsigned long long)seed,
+            (unsigned long long)(sim->generation - period), (unsigned long long)period, population);
+        en->settled++;
+    }
+    else
+        fprintf(en->out, "%llu,%llu,,%llu\n", (unsigned long long)seed, (unsigned long long)sim->generation, population);
+
+    SDL_UnlockMutex(en->writing);
+}
+
+static void ensemble_work(void* ctx, int index, int count)
+{
+    ensemble* en = ctx;
+    uint64_t seed;
+
+    (void)count;
+
+    while (take_seed(en, index, &seed))
+        run_soup(en, &en->jobs[index], seed);
+}
+
+// Make every job's engine and cycle table, returns 0 and says why if one
+// of them couldn't be made
+static int jobs_init(ensemble* en)
+{
+    const options* opts = en->opts;
+    uint64_t first = (uint64_t)opts->first_seed;
+    uint64_t total = (uint64_t)opts->last_seed - first + 1;
+
+    for (int i = 0; i < en->count; i++)
+    {
+        ensemble_job* job = &en->jobs[i];
+
+        // Spread the leftover seeds over the first few, like workers_band()
+        uint64_t size = total / en->count;
+        uint64_t extra = total % en->count;
+
+        job->queue.next = first + size * i + ((uint64_t)i < extra ? (uint64_t)i : extra);
+        job->queue.end = job->queue.next + size + ((uint64_t)i < extra ? 1 : 0);
+
+        job->sim = engine_create(opts->engine, opts->width, opts->height);
+
+        if (!job->sim)
+        {
+            printf("Unable to create a %dx%d grid with the \"%s\" engine!\n", opts->width, opts->height, opts->engine);
+            return 0;
+        }
+
+        // Its context belongs to the thread that made it
+        if (job->sim->texture && en->count > 1)
+        {
+            printf("The \"%s\" engine can only run one soup at a time, use --jobs 1\n", opts->engine);
+            return 0;
+        }
+
+        if (!engine_set_wrap(job->sim, opts->wrap))
+        {
+            printf("The \"%s\" engine can't wrap around at the edges!\n", opts->engine);
+            return 0;
+        }
+
+        if (!engine_set_rule(job->sim, &opts->rule))
+        {
+            printf("The \"%s\" engine can only run B3/S23!\n", opts->engine);
+            return 0;
+        }
+
+        job->seen = cycles_create();
+
+        if (!job->seen)
+        {
+            printf("Out of memory!\n");
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+int ensemble_run(const options* opts)
+{
+    // Never more threads than soups
+    uint64_t soups = (uint64_t)opts->last_seed - (uint64_t)opts->first_seed + 1;
+    int jobs = opts->jobs;
+
+    if (jobs > 0 && (uint64_t)jobs > soups)
+        jobs = (int)soups;
+
+    workers* pool = workers_create(jobs);
+
+    if (!pool)
+    {
+        printf("Unable to start worker threads!\n");
+        return -1;
+    }
+
+    ensemble en = { 0 };
+    en.opts = opts;
+    en.count = workers_count(pool);
+    en.jobs = calloc(en.count, sizeof(ensemble_job));
+    en.writing = SDL_CreateMutex();
+    en.out = stdout;
+
+    int result = -1;
+
+    if (!en.jobs || !en.writing)
+        printf("Out of memory!\n");
+    else if (opts->out && !(en.out = fopen(opts->out, "w")))
+        printf("Unable to open %s!\n", opts->out);
+    else if (jobs_init(&en))
+        result = 0;
+
+    if (result == 0)
+    {
+        fprintf(en.out, "seed,lifetime,period,population\n");
+
+        Uint64 start = SDL_GetPerformanceCounter();
+
+        workers_run(pool, ensemble_work, &en);
+
+        Uint64 end = SDL_GetPerformanceCounter();
+        double seconds = (double)(end - start) / SDL_GetPerformanceFrequency();
+
+        // With the lines on the console this would end up in the CSV
+        if (opts->out)
+        {
+            printf("%llu soups of %dx%d on %d threads with the %s engine in %.3f s, %llu settled within %lld generations\n",
+                (unsigned long long)soups, opts->width, opts->height, en.count, en.jobs[0].sim->name, seconds,
+                (unsigned long long)en.settled, opts->gens);
+
+            if (seconds > 0)
+                printf("%.1f soups/s\n", soups / seconds);
+        }
+    }
+
+    if (en.out && en.out != stdout && fclose(en.out) != 0 && result == 0)
+    {
+        printf("Unable to write %s!\n", opts->out);
+        result = -1;
+    }
+
+    for (int i = 0; en.jobs && i < en.count; i++)
+    {
+        if (en.jobs[i].sim)
+            en.jobs[i].sim->destroy(en.jobs[i].sim);
+        cycles_destroy(en.jobs[i].seen);
+    }
+
+    if (en.writing)
+        SDL_DestroyMutex(en.writing);
+
+    free(en.jobs);
+    workers_destroy(pool);
+
+    return result;
+}
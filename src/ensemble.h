@@ -0,0 +1,28 @@
+/* ensemble.h - Running lots of random soups
+ *
+ * With --ensemble FIRST,LAST every seed in that range gets a random soup of
+ * its own (see soup.h), filling the whole grid at --density, which runs
+ * until it settles into a cycle (see cycles.h) or --gens generations have
+ * gone by. Each one writes a line of CSV with how long it took to settle,
+ * the period it settled into and how many cells were left.
+ *
+ * The soups run --jobs at a time, every one on a single thread, since lots
+ * of small grids side by side keep every core a lot busier than one grid
+ * split up between them. Every thread starts with an even share of the
+ * seeds, and once it's through them it takes half of what's left from
+ * another thread, so the ones that got long lived soups don't hold up the
+ * rest. Each thread makes its engine and cycle table once and reuses them
+ * for every soup. Lines get written in whatever order the soups finish.
+*/
+
+#ifndef ENSEMBLE_H
+#define ENSEMBLE_H
+
+#include "options.h"
+
+// Run every soup from opts->first_seed to opts->last_seed and write the
+// lines to opts->out, or to the console without it. Returns the exit code
+// for main().
+int ensemble_run(const options* opts);
+
+#endif
@@ -0,0 +1,92 @@
+/* gl.c - OpenGL functions
+*/
+
+#include <stdio.h>
+#include "gl.h"
+
+gl_functions gl;
+
+const char* const gl_cover_shader =
+    "#version 130\n"
+    "void main()\n"
+    "{\n"
+    "    vec2 corner = vec2(float((gl_VertexID & 1) * 4 - 1), float((gl_VertexID & 2) * 2 - 1));\n"
+    "    gl_Position = vec4(corner, 0.0, 1.0);\n"
+    "}\n";
+
+int gl_load(void)
+{
+    int ok = 1;
+
+#define LOAD_FUNCTION(type, name, args) \
+    gl.name = (type (APIENTRY*) args)SDL_GL_GetProcAddress("gl" #name); \
+    ok = ok && gl.name;
+
+    GL_FUNCTIONS(LOAD_FUNCTION)
+
+#undef LOAD_FUNCTION
+
+    return ok;
+}
+
+static GLuint compile(GLenum type, const char* source)
+{
+    GLuint shader = gl.CreateShader(type);
+    gl.ShaderSource(shader, 1, &source, NULL);
+    gl.CompileShader(shader);
+
+    GLint ok = 0;
+    gl.GetShaderiv(shader, GL_COMPILE_STATUS, &ok);
+
+    if (!ok)
+    {
+        char log[1024];
+        gl.GetShaderInfoLog(shader, sizeof(log), NULL, log);
+        printf("Unable to compile a shader: %s\n", log);
+
+        gl.DeleteShader(shader);
+        return 0;
+    }
+
+    return shader;
+}
+
+GLuint gl_program(const char* vertex, const char* fragment, const char* output)
+{
+    GLuint vs = compile(GL_VERTEX_SHADER, vertex);
+    GLuint fs = compile(GL_FRAGMENT_SHADER, fragment);
+
+    if (!vs || !fs)
+    {
+        if (vs)
+            gl.DeleteShader(vs);
+        if (fs)
+            gl.DeleteShader(fs);
+        return 0;
+    }
+
+    GLuint program = gl.CreateProgram();
+    gl.AttachShader(program, vs);
+    gl.AttachShader(program, fs);
+    gl.BindFragDataLocation(program, 0, output);
+    gl.LinkProgram(program);
+
+    // The program keeps them around for as long as it needs them
+    gl.DeleteShader(vs);
+    gl.DeleteShader(fs);
+
+    GLint ok = 0;
+    gl.GetProgramiv(program, GL_LINK_STATUS, &ok);
+
+    if (!ok)
+    {
+        char log[1024];
+        gl.GetProgramInfoLog(program, sizeof(log), NULL, log);
+        printf("Unable to link a shader program: %s\n", log);
+
+        gl.DeleteProgram(program);
+        return 0;
+    }
+
+    return program;
+}
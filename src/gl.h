@@ -0,0 +1,89 @@
+/* gl.h - OpenGL functions
+ *
+ * SDL makes the contexts, but everything past OpenGL 1.1 has to be looked
+ * up at runtime, and on some platforms even the 1.1 functions don't get
+ * linked in without asking for them. So every function we use is looked up
+ * through SDL_GL_GetProcAddress() into one table, and nothing has to be
+ * linked against OpenGL at build time.
+ *
+ * Everything here needs OpenGL 3.0 (GLSL 1.30) for integer textures and
+ * texelFetch, in a core or compatibility context.
+*/
+
+#ifndef GL_H
+#define GL_H
+
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_opengl.h>
+
+// Return type, name without the gl and arguments of every function we use
+#define GL_FUNCTIONS(X) \
+    X(GLenum, GetError, (void)) \
+    X(void, GetIntegerv, (GLenum pname, GLint* data)) \
+    X(GLboolean, IsEnabled, (GLenum cap)) \
+    X(void, Enable, (GLenum cap)) \
+    X(void, Disable, (GLenum cap)) \
+    X(void, Viewport, (GLint x, GLint y, GLsizei width, GLsizei height)) \
+    X(void, Flush, (void)) \
+    X(void, Finish, (void)) \
+    X(void, PixelStorei, (GLenum pname, GLint param)) \
+    X(void, GenTextures, (GLsizei n, GLuint* textures)) \
+    X(void, DeleteTextures, (GLsizei n, const GLuint* textures)) \
+    X(void, BindTexture, (GLenum target, GLuint texture)) \
+    X(void, ActiveTexture, (GLenum texture)) \
+    X(void, TexParameteri, (GLenum target, GLenum pname, GLint param)) \
+    X(void, TexImage2D, (GLenum target, GLint level, GLint internalformat, GLsizei width, GLsizei height, GLint border, GLenum format, GLenum type, const void* pixels)) \
+    X(void, TexSubImage2D, (GLenum target, GLint level, GLint xoffset, GLint yoffset, GLsizei width, GLsizei height, GLenum format, GLenum type, const void* pixels)) \
+    X(void, ReadPixels, (GLint x, GLint y, GLsizei width, GLsizei height, GLenum format, GLenum type, void* pixels)) \
+    X(void, GenFramebuffers, (GLsizei n, GLuint* framebuffers)) \
+    X(void, DeleteFramebuffers, (GLsizei n, const GLuint* framebuffers)) \
+    X(void, BindFramebuffer, (GLenum target, GLuint framebuffer)) \
+    X(void, FramebufferTexture2D, (GLenum target, GLenum attachment, GLenum textarget, GLuint texture, GLint level)) \
+    X(GLenum, CheckFramebufferStatus, (GLenum target)) \
+    X(void, ClearBufferuiv, (GLenum buffer, GLint drawbuffer, const GLuint* value)) \
+    X(void, GenVertexArrays, (GLsizei n, GLuint* arrays)) \
+    X(void, DeleteVertexArrays, (GLsizei n, const GLuint* arrays)) \
+    X(void, BindVertexArray, (GLuint array)) \
+    X(void, DrawArrays, (GLenum mode, GLint first, GLsizei count)) \
+    X(GLuint, CreateShader, (GLenum type)) \
+    X(void, ShaderSource, (GLuint shader, GLsizei count, const GLchar* const* string, const GLint* length)) \
+    X(void, CompileShader, (GLuint shader)) \
+    X(void, GetShaderiv, (GLuint shader, GLenum pname, GLint* params)) \
+    X(void, GetShaderInfoLog, (GLuint shader, GLsizei size, GLsizei* length, GLchar* log)) \
+    X(void, DeleteShader, (GLuint shader)) \
+    X(GLuint, CreateProgram, (void)) \
+    X(void, AttachShader, (GLuint program, GLuint shader)) \
+    X(void, BindFragDataLocation, (GLuint program, GLuint color, const GLchar* name)) \
+    X(void, LinkProgram, (GLuint program)) \
+    X(void, GetProgramiv, (GLuint program, GLenum pname, GLint* params)) \
+    X(void, GetProgramInfoLog, (GLuint program, GLsizei size, GLsizei* length, GLchar* log)) \
+    X(void, DeleteProgram, (GLuint program)) \
+    X(void, UseProgram, (GLuint program)) \
+    X(GLint, GetUniformLocation, (GLuint program, const GLchar* name)) \
+    X(void, Uniform1i, (GLint location, GLint v0)) \
+    X(void, Uniform2i, (GLint location, GLint v0, GLint v1)) \
+    X(void, Uniform1f, (GLint location, GLfloat v0))
+
+#define GL_FUNCTION_POINTER(type, name, args) type (APIENTRY* name) args;
+
+typedef struct
+{
+    GL_FUNCTIONS(GL_FUNCTION_POINTER)
+} gl_functions;
+
+// Call them as gl.Viewport(...) and so on, once gl_load() worked
+extern gl_functions gl;
+
+// Look everything up, with a context current. Returns 0 if some function
+// isn't there, which means OpenGL is older than 3.0.
+int gl_load(void);
+
+// Vertex shader for drawing one triangle that covers the whole viewport,
+// with glDrawArrays(GL_TRIANGLES, 0, 3) and no vertices
+extern const char* const gl_cover_shader;
+
+// Compile and link a program that draws to output, returns 0 and prints
+// why if it didn't work
+GLuint gl_program(const char* vertex, const char* fragment, const char* output);
+
+#endif
@@ -0,0 +1,172 @@
+/* gol.c - The simulation as a library
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include "gol.h"
+#include "engine.h"
+#include "workers.h"
+#include "rule.h"
+#include "soup.h"
+#include "savefile.h"
+#include "pattern.h"
+
+struct gol
+{
+    engine* sim;
+
+    // Ours, the engine only borrows it. NULL when stepping on one thread.
+    workers* pool;
+};
+
+gol* gol_create(const char* engine_name, int width, int height)
+{
+    if (width <= 0 || height <= 0)
+        return NULL;
+
+    gol* g = calloc(1, sizeof(gol));
+    if (!g)
+        return NULL;
+
+    g->sim = engine_create(engine_name ? engine_name : "bit", width, height);
+
+    if (!g->sim)
+    {
+        free(g);
+        return NULL;
+    }
+
+    return g;
+}
+
+void gol_destroy(gol* g)
+{
+    if (!g)
+        return;
+
+    g->sim->destroy(g->sim);
+    workers_destroy(g->pool);
+    free(g);
+}
+
+const char* gol_engine(const gol* g)
+{
+    return g->sim->name;
+}
+
+int gol_width(const gol* g)
+{
+    return g->sim->width;
+}
+
+int gol_height(const gol* g)
+{
+    return g->sim->height;
+}
+
+int gol_set_rule(gol* g, const char* text)
+{
+    rule r;
+    return rule_parse(text, &r) && engine_set_rule(g->sim, &r);
+}
+
+int gol_set_wrap(gol* g, int wrap)
+{
+    return engine_set_wrap(g->sim, wrap != 0);
+}
+
+int gol_set_threads(gol* g, int threads)
+{
+    g->sim->pool = NULL;
+    workers_destroy(g->pool);
+    g->pool = NULL;
+
+    if (threads == 1)
+        return 1;
+
+    g->pool = workers_create(threads);
+    g->sim->pool = g->pool;
+
+    return g->pool != NULL;
+}
+
+int gol_step(gol* g, uint64_t n)
+{
+    return engine_advance(g->sim, n);
+}
+
+uint64_t gol_generation(const gol* g)
+{
+    return g->sim->generation;
+}
+
+// Everything past the edges is dead, even for engines that keep going
+// there, so reading never has to worry about the size
+int gol_get_cell(gol* g, int x, int y)
+{
+    if (x < 0 || x >= g->sim->width || y < 0 || y >= g->sim->height)
+        return 0;
+
+    return g->sim->get_cell(g->sim, x, y) ? 1 : 0;
+}
+
+int gol_set_cell(gol* g, int x, int y, int alive)
+{
+    if (x < 0 || x >= g->sim->width || y < 0 || y >= g->sim->height)
+        return 1;
+
+    g->sim->out_of_memory = 0;
+    g->sim->set_cell(g->sim, x, y, alive ? 1 : 0);
+
+    return !g->sim->out_of_memory;
+}
+
+void gol_get_row(gol* g, int y, uint8_t* out)
+{
+    if (y < 0 || y >= g->sim->height)
+    {
+        memset(out, 0, g->sim->width);
+        return;
+    }
+
+    g->sim->get_row(g->sim, y, out);
+
+    // Engines are allowed other bits than CELL_ALIVE in their bytes
+    for (int x = 0; x < g->sim->width; x++)
+    {
+        out[x] &= CELL_ALIVE;
+    }
+}
+
+void gol_clear(gol* g)
+{
+    g->sim->clear(g->sim);
+}
+
+void gol_soup(gol* g, uint64_t seed, double density)
+{
+    soup_fill(g->sim, seed, density, 0, 0, g->sim->width, g->sim->height);
+}
+
+// Not the census, which counts everything hashlife and sparse have even
+// past the edges. engine_population() and engine_hash() only read the rows
+// of the grid.
+uint64_t gol_population(gol* g)
+{
+    return engine_population(g->sim);
+}
+
+uint64_t gol_hash(gol* g)
+{
+    return engine_hash(g->sim);
+}
+
+int gol_save(gol* g, const char* path)
+{
+    return savefile_save(path, g->sim);
+}
+
+int gol_load(gol* g, const char* path)
+{
+    return pattern_load(path, g->sim, PATTERN_CENTER, PATTERN_CENTER);
+}
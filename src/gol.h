@@ -0,0 +1,82 @@
+/* gol.h - The simulation as a library
+ *
+ * Everything that steps, loads and saves grids builds into libgol (make
+ * lib) without any of the window, so other programs can run Life without
+ * knowing about engines, rules or file formats. This is all they need to
+ * include. The grid is a handle that only goes through these functions, so
+ * they keep working the same no matter what changes inside.
+ *
+ * The engines are the same ones as --engine (see engine.h), and so are the
+ * rules (see rule.h) and files (see savefile.h and pattern.h). Threads come
+ * from SDL, so programs using the library link with SDL2 too, but never
+ * have to initialize it. A grid can only be used by one thread at a time.
+*/
+
+#ifndef GOL_H
+#define GOL_H
+
+#include <stdint.h>
+
+// Bumped whenever something below changes in a way that breaks programs
+// built against an older version
+#define GOL_API_VERSION 1
+
+typedef struct gol gol;
+
+// Make a width x height grid of dead cells, stepped with the engine called
+// engine ("bit" if NULL). Returns NULL if there's no such engine or no
+// memory for the grid.
+gol* gol_create(const char* engine, int width, int height);
+void gol_destroy(gol* g);
+
+// Which engine it ended up with, and the grid size
+const char* gol_engine(const gol* g);
+int gol_width(const gol* g);
+int gol_height(const gol* g);
+
+// Run rule, written like "B36/S23" or a name like "highlife". Returns 0 if
+// it doesn't make sense or the engine can't run it, and then the rule stays
+// what it was.
+int gol_set_rule(gol* g, const char* rule);
+
+// Wrap around at the edges, returns 0 if the engine can't
+int gol_set_wrap(gol* g, int wrap);
+
+// Step every generation on this many threads, 0 for one per core. Returns
+// 0 if the threads couldn't be started, and then it steps on one.
+int gol_set_threads(gol* g, int threads);
+
+// Step n generations, and how many there have been (loading a file sets it
+// to the file's). Any n up to UINT64_MAX works, hashlife splits the big ones
+// into jumps of at most 2^58 generations. Returns 0 if the engine ran out
+// of memory on the way (only hashlife and sparse ever do), and then the
+// grid and the generation are as far as it got.
+int gol_step(gol* g, uint64_t n);
+uint64_t gol_generation(const gol* g);
+
+// Cells are 1 if alive and 0 if dead. get_row fills out with gol_width()
+// bytes, one for every cell of row y. Cells and rows past the edges of the
+// grid are all dead. set_cell returns 0 if there was no memory to change
+// the cell, which then stays the way it was.
+int gol_get_cell(gol* g, int x, int y);
+int gol_set_cell(gol* g, int x, int y, int alive);
+void gol_get_row(gol* g, int y, uint8_t* out);
+
+// Kill every cell, or fill the grid with a random soup that has density (0
+// to 1) of its cells alive, the same soup for the same seed every time
+void gol_clear(gol* g);
+void gol_soup(gol* g, uint64_t seed, double density);
+
+// How many cells in the grid are alive, and a hash of the grid that's the
+// same for the same cells (see hash.h). Both only go by what's inside the
+// edges, just like gol_get_row(), so cells that hashlife and sparse keep
+// stepping after they leave the grid don't count.
+uint64_t gol_population(gol* g);
+uint64_t gol_hash(gol* g);
+
+// Save to a .gol file, or load a .gol, .rle or .cells file. Patterns go in
+// the middle of the grid. Both return 1 on success.
+int gol_save(gol* g, const char* path);
+int gol_load(gol* g, const char* path);
+
+#endif
@@ -0,0 +1,185 @@
+/* gpuview.c - Drawing a grid that's already on the GPU
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include "gpuview.h"
+#include "gl.h"
+
+// Most cells looked at across every block zoomed out
+#define GPUVIEW_SAMPLES 8
+
+struct gpuview
+{
+    SDL_Renderer* renderer;
+    SDL_Window* window;
+    SDL_GLContext context;
+
+    GLuint program;
+    GLuint vertices;
+    GLint grid_at;
+    GLint view_at;
+    GLint zoom_at;
+    GLint shift_at;
+    GLint scale_at;
+    GLint top_at;
+    GLint dim_at;
+    GLint most_at;
+};
+
+static const char* const view_shader =
+    "#version 130\n"
+    "uniform usampler2D cells;\n"
+    "uniform ivec2 grid;\n"
+    "uniform ivec2 view;\n"
+    "uniform int zoom;\n"
+    "uniform int shift;\n"
+    "uniform float scale;\n"
+    "uniform float top;\n"
+    "uniform float dim;\n"
+    "uniform int most;\n"
+    "out vec4 color;\n"
+    "void main()\n"
+    "{\n"
+    "    ivec2 pixel = ivec2(vec2(gl_FragCoord.x, top - gl_FragCoord.y) / scale);\n"
+    "    ivec2 block = view + ((pixel / zoom) << shift);\n"
+    "    int size = 1 << shift;\n"
+    "    int stride = max(size / most, 1);\n"
+    "    int alive = 0;\n"
+    "    int samples = 0;\n"
+    "    for (int y = 0; y < size; y += stride)\n"
+    "    {\n"
+    "        for (int x = 0; x < size; x += stride)\n"
+    "        {\n"
+    "            ivec2 cell = block + ivec2(x, y);\n"
+    "            samples++;\n"
+    "            if (all(greaterThanEqual(cell, ivec2(0))) && all(lessThan(cell, grid)))\n"
+    "                alive += int(texelFetch(cells, cell, 0).r);\n"
+    "        }\n"
+    "    }\n"
+    "    float level = 0.0;\n"
+    "    if (alive > 0)\n"
+    "        level = shift == 0 ? 1.0 : min(1.0, dim + (1.0 - dim) * 2.0 * float(alive) / float(samples));\n"
+    "    color = vec4(level, level, level, 1.0);\n"
+    "}\n";
+
+gpuview* gpuview_create(SDL_Renderer* renderer)
+{
+    SDL_RendererInfo info;
+
+    if (SDL_GetRendererInfo(renderer, &info) != 0 || strcmp(info.name, "opengl") != 0)
+        return NULL;
+
+    gpuview* v = calloc(1, sizeof(gpuview));
+    if (!v)
+        return NULL;
+
+    v->renderer = renderer;
+    v->window = SDL_GL_GetCurrentWindow();
+    v->context = SDL_GL_GetCurrentContext();
+
+    if (!v->context || !gl_load())
+    {
+        free(v);
+        return NULL;
+    }
+
+    // Whatever SDL had bound stays bound
+    GLint program = 0;
+    gl.GetIntegerv(GL_CURRENT_PROGRAM, &program);
+
+    v->program = gl_program(gl_cover_shader, view_shader, "color");
+
+    if (!v->program)
+    {
+        free(v);
+        return NULL;
+    }
+
+    gl.UseProgram(v->program);
+    gl.Uniform1i(gl.GetUniformLocation(v->program, "cells"), 0);
+    v->grid_at = gl.GetUniformLocation(v->program, "grid");
+    v->view_at = gl.GetUniformLocation(v->program, "view");
+    v->zoom_at = gl.GetUniformLocation(v->program, "zoom");
+    v->shift_at = gl.GetUniformLocation(v->program, "shift");
+    v->scale_at = gl.GetUniformLocation(v->program, "scale");
+    v->top_at = gl.GetUniformLocation(v->program, "top");
+    v->dim_at = gl.GetUniformLocation(v->program, "dim");
+    v->most_at = gl.GetUniformLocation(v->program, "most");
+    gl.UseProgram(program);
+
+    // Vertex arrays aren't shared between contexts, so this one's ours
+    gl.GenVertexArrays(1, &v->vertices);
+
+    return v;
+}
+
+void gpuview_destroy(gpuview* v)
+{
+    if (!v)
+        return;
+
+    SDL_GL_MakeCurrent(v->window, v->context);
+    gl.DeleteVertexArrays(1, &v->vertices);
+    gl.DeleteProgram(v->program);
+
+    free(v);
+}
+
+void gpuview_draw(gpuview* v, const render* r, unsigned int texture)
+{
+    // Everything SDL queued up goes first, and then it's our turn in its
+    // context
+    SDL_RenderFlush(v->renderer);
+
+    if (SDL_GL_GetCurrentContext() != v->context)
+        SDL_GL_MakeCurrent(v->window, v->context);
+
+    // SDL remembers what it last set instead of asking, so all of it has
+    // to be the same afterwards
+    GLint program, vertices, active, bound;
+    GLint viewport[4];
+
+    gl.GetIntegerv(GL_CURRENT_PROGRAM, &program);
+    gl.GetIntegerv(GL_VERTEX_ARRAY_BINDING, &vertices);
+    gl.GetIntegerv(GL_ACTIVE_TEXTURE, &active);
+    gl.ActiveTexture(GL_TEXTURE0);
+    gl.GetIntegerv(GL_TEXTURE_BINDING_2D, &bound);
+    gl.GetIntegerv(GL_VIEWPORT, viewport);
+
+    GLboolean blend = gl.IsEnabled(GL_BLEND);
+    GLboolean scissor = gl.IsEnabled(GL_SCISSOR_TEST);
+
+    // The drawable can have more pixels than the window on high DPI screens
+    int width, height;
+    SDL_GL_GetDrawableSize(v->window, &width, &height);
+
+    gl.Disable(GL_BLEND);
+    gl.Disable(GL_SCISSOR_TEST);
+    gl.Viewport(0, 0, width, height);
+
+    gl.UseProgram(v->program);
+    gl.Uniform2i(v->grid_at, r->grid_width, r->grid_height);
+    gl.Uniform2i(v->view_at, r->view_x, r->view_y);
+    gl.Uniform1i(v->zoom_at, r->zoom);
+    gl.Uniform1i(v->shift_at, r->shift);
+    gl.Uniform1f(v->scale_at, (float)width / r->window_width);
+    gl.Uniform1f(v->top_at, (float)height);
+    gl.Uniform1f(v->dim_at, RENDER_DIM / 255.0f);
+    gl.Uniform1i(v->most_at, GPUVIEW_SAMPLES);
+
+    gl.BindVertexArray(v->vertices);
+    gl.BindTexture(GL_TEXTURE_2D, texture);
+    gl.DrawArrays(GL_TRIANGLES, 0, 3);
+
+    gl.BindTexture(GL_TEXTURE_2D, bound);
+    gl.ActiveTexture(active);
+    gl.BindVertexArray(vertices);
+    gl.UseProgram(program);
+    gl.Viewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+
+    if (blend)
+        gl.Enable(GL_BLEND);
+    if (scissor)
+        gl.Enable(GL_SCISSOR_TEST);
+}
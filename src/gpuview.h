@@ -0,0 +1,33 @@
+/* gpuview.h - Drawing a grid that's already on the GPU
+ *
+ * The gpu engine keeps its grid in a texture (see texture in engine.h), so
+ * instead of counting texels out of it on the CPU and uploading them, the
+ * window draws the view with a shader that reads the cells straight out of
+ * that texture. Zoomed out, every pixel looks at up to 8x8 cells spread
+ * over its block and gets brighter the more of them are alive, the same
+ * way render.c colors blocks it counted all of.
+ *
+ * This only works with SDL's OpenGL renderer, in a context that shares
+ * textures with the engine's (main.c sets that up). Whatever else SDL
+ * draws keeps working, everything it had set up gets put back afterwards.
+*/
+
+#ifndef GPUVIEW_H
+#define GPUVIEW_H
+
+#include <SDL2/SDL.h>
+#include "render.h"
+
+typedef struct gpuview gpuview;
+
+// Get ready to draw on renderer, right after it was made, while its
+// context is still the current one. Returns NULL if it isn't SDL's OpenGL
+// renderer or its context can't run the shader, and then the grid gets
+// drawn the usual way.
+gpuview* gpuview_create(SDL_Renderer* renderer);
+void gpuview_destroy(gpuview* v);
+
+// Draw the view of r from texture, the engine's texture
+void gpuview_draw(gpuview* v, const render* r, unsigned int texture);
+
+#endif
@@ -0,0 +1,32 @@
+/* hash.h - Grid hashing
+ *
+ * A grid's hash is every 64 cell word of it (bit-packed, rows padded out to
+ * a whole word) hashed together with its position and XORed together. XOR
+ * means an engine that knows which words changed can update the hash from
+ * just those: XOR out the old word's hash and XOR in the new one.
+*/
+
+#ifndef HASH_H
+#define HASH_H
+
+#include <stdint.h>
+
+// The splitmix64 finalizer, every bit of x ends up affecting every bit of
+// the result
+static inline uint64_t hash_mix(uint64_t x)
+{
+    x ^= x >> 30;
+    x *= 0xBF58476D1CE4E5B9ULL;
+    x ^= x >> 27;
+    x *= 0x94D049BB133111EBULL;
+    x ^= x >> 31;
+    return x;
+}
+
+// Hash of word number index of a grid, counting row by row
+static inline uint64_t hash_word(uint64_t word, uint64_t index)
+{
+    return hash_mix(word + index * 0x9E3779B97F4A7C15ULL);
+}
+
+#endif
@@ -0,0 +1,265 @@
+/* headless.c - Running without a window
+*/
+
+#include <SDL2/SDL.h>
+#include <stdio.h>
+#include <string.h>
+#include "headless.h"
+#include "savefile.h"
+#include "pattern.h"
+#include "saver.h"
+#include "cycles.h"
+#include "stats.h"
+
+void headless_checkpoint_path(const options* opts, uint64_t generation, char* path, size_t size)
+{
+    const char* base = opts->out ? opts->out : "checkpoint.gol";
+    size_t length = strlen(base);
+
+    if (length >= 4 && SDL_strcasecmp(&base[length - 4], ".gol") == 0)
+        length -= 4;
+
+    snprintf(path, size, "%.*s-%llu.gol", (int)length, base, (unsigned long long)generation);
+}
+
+static void checkpoint(const options* opts, engine* sim, saver* checkpoints)
+{
+    char path[1024];
+    headless_checkpoint_path(opts, sim->generation, path, sizeof(path));
+
+    // Falling behind is better than stalling, the next one will make it
+    if (!saver_save(checkpoints, sim, path))
+        printf("Still writing the last checkpoint, skipping %s\n", path);
+
+    int ok;
+    if (saver_finished(checkpoints, &ok) && !ok)
+        printf("Unable to save a checkpoint!\n");
+}
+
+// Parts of every stretch of generations timed for --stats
+enum
+{
+    PHASE_STEP,
+    PHASE_CYCLES,
+    PHASE_CHECKPOINT
+};
+
+// How far to go before something else has to happen every "every"
+// generations, done generations in
+static uint64_t until(uint64_t gens, uint64_t done, uint64_t every)
+{
+    return gens > every - done % every ? every - done % every : gens;
+}
+
+// One line of the CSV file for the generations since the stopwatch was last
+// started, with the births and deaths since last, which is updated to now.
+// They're left empty if the engine can't count them. The population comes
+// from the census too, except for hashlife and sparse, whose census counts
+// the cells outside the grid as well. None of it is counted in the timings.
+static void write_stats(FILE* csv, engine* sim, uint64_t gens, const stats* timer, census* last)
+{
+    double seconds = stats_seconds(timer);
+
+    census now;
+    int changes = engine_census(sim, &now);
+    uint64_t population = sim->unbounded ? engine_population(sim) : now.population;
+
+    fprintf(csv, "%llu,%llu,%.3f,%.3f,%.3f,%.1f,%llu,",
+        (unsigned long long)sim->generation, (unsigned long long)gens,
+        stats_ms(timer, PHASE_STEP), stats_ms(timer, PHASE_CYCLES), stats_ms(timer, PHASE_CHECKPOINT),
+        seconds > 0 ? gens / seconds : 0, (unsigned long long)population);
+
+    if (changes)
+        fprintf(csv, "%llu,%llu\n", (unsigned long long)(now.births - last->births), (unsigned long long)(now.deaths - last->deaths));
+    else
+        fprintf(csv, ",\n");
+
+    *last = now;
+}
+
+// Step the simulation, handing a copy to the saver every checkpoint_every
+// generations and looking for cycles after every generation if asked to.
+// The saver writes on its own thread, so stepping only ever waits for the
+// copy. Returns how many generations were stepped.
+static uint64_t run(const options* opts, engine* sim, saver* checkpoints, cycles* seen, FILE* csv)
+{
+    uint64_t total = (uint64_t)opts->gens;
+    uint64_t every = (uint64_t)opts->checkpoint_every;
+    uint64_t stats_every = (uint64_t)opts->stats_every;
+    uint64_t done = 0;
+    uint64_t logged = 0;
+    int reported = 0;
+
+    // The starting grid counts too, it can come back later
+    uint64_t period;
+    if (seen)
+        cycles_check(seen, sim, &period);
+
+    // Starts the engine counting births and deaths as it steps
+    census counted;
+    if (csv)
+        engine_census(sim, &counted);
+
+    stats timer;
+    stats_start(&timer);
+
+    while (done < total)
+    {
+        // Looking for cycles has to see every generation, otherwise go as far
+        // as possible at once so hashlife can jump
+        uint64_t gens = total - done;
+
+        if (seen)
+            gens = 1;
+        if (checkpoints)
+            gens = until(gens, done, every);
+        if (csv)
+            gens = until(gens, done, stats_every);
+
+        uint64_t before = sim->generation;
+        int stepped = engine_advance(sim, gens);
+
+        done += sim->generation - before;
+        stats_lap(&timer, PHASE_STEP);
+
+        if (!stepped)
+        {
+            printf("Out of memory at generation %llu!\n", (unsigned long long)sim->generation);
+            break;
+        }
+
+        int stop = 0;
+
+        if (seen && !reported && cycles_check(seen, sim, &period))
+        {
+            if (period == 1)
+                printf("Stopped changing at generation %llu\n", (unsigned long long)(sim->generation - 1));
+            else
+                printf("Generation %llu is the same as generation %llu, repeating every %llu generations\n",
+                    (unsigned long long)sim->generation, (unsigned long long)(sim->generation - period), (unsigned long long)period);
+
+            stop = opts->stop_on_cycle;
+
+            // Only the first one is interesting, and stepping big jumps
+            // again is a lot faster
+            reported = 1;
+            seen = NULL;
+        }
+
+        stats_lap(&timer, PHASE_CYCLES);
+
+        if (checkpoints && done % every == 0)
+            checkpoint(opts, sim, checkpoints);
+
+        stats_lap(&timer, PHASE_CHECKPOINT);
+
+        if (csv && (done % stats_every == 0 || done == total || stop))
+        {
+            write_stats(csv, sim, done - logged, &timer, &counted);
+            logged = done;
+            stats_start(&timer);
+        }
+
+        if (stop)
+            break;
+    }
+
+    return done;
+}
+
+int headless_run(const options* opts, engine* sim)
+{
+    if (opts->in && !pattern_load(opts->in, sim, opts->offset_x, opts->offset_y))
+    {
+        printf("Unable to load %s!\n", opts->in);
+        return -1;
+    }
+
+    saver* checkpoints = NULL;
+
+    if (opts->checkpoint_every > 0)
+    {
+        checkpoints = saver_create();
+
+        if (!checkpoints)
+        {
+            printf("Unable to start the saving thread!\n");
+            return -1;
+        }
+    }
+
+    cycles* seen = NULL;
+
+    if (opts->detect_cycles)
+    {
+        seen = cycles_create();
+
+        if (!seen)
+        {
+            printf("Out of memory!\n");
+            saver_destroy(checkpoints);
+            return -1;
+        }
+    }
+
+    FILE* csv = NULL;
+
+    if (opts->stats)
+    {
+        csv = fopen(opts->stats, "w");
+
+        if (!csv)
+        {
+            printf("Unable to open %s!\n", opts->stats);
+            cycles_destroy(seen);
+            saver_destroy(checkpoints);
+            return -1;
+        }
+
+        fprintf(csv, "generation,gens,step_ms,cycles_ms,checkpoint_ms,gens_per_s,population,births,deaths\n");
+    }
+
+    Uint64 start = SDL_GetPerformanceCounter();
+
+    uint64_t gens = run(opts, sim, checkpoints, seen, csv);
+
+    Uint64 end = SDL_GetPerformanceCounter();
+    double seconds = (double)(end - start) / SDL_GetPerformanceFrequency();
+    double cells = (double)sim->width * sim->height;
+
+    cycles_destroy(seen);
+
+    int result = 0;
+
+    if (csv && fclose(csv) != 0)
+    {
+        printf("Unable to write %s!\n", opts->stats);
+        result = -1;
+    }
+
+    printf("%llu generations of %dx%d on the %s engine in %.3f s\n", (unsigned long long)gens, sim->width, sim->height, sim->name, seconds);
+
+    if (seconds > 0)
+    {
+        printf("%.1f generations/s, %.3g cell updates/s\n", gens / seconds, gens * cells / seconds);
+    }
+
+    if (checkpoints)
+    {
+        if (!saver_wait(checkpoints))
+        {
+            printf("Unable to save a checkpoint!\n");
+            result = -1;
+        }
+
+        saver_destroy(checkpoints);
+    }
+
+    if (opts->out && !savefile_save(opts->out, sim))
+    {
+        printf("Unable to save %s!\n", opts->out);
+        return -1;
+    }
+
+    return result;
+}
@@ -0,0 +1,24 @@
+/* headless.h - Running without a window
+ *
+ * Steps the simulation as fast as it can without ever touching the video
+ * side of SDL, so it can run on servers that don't have a display.
+*/
+
+#ifndef HEADLESS_H
+#define HEADLESS_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "engine.h"
+#include "options.h"
+
+// Load opts->in, step opts->gens generations and save to opts->out.
+// Returns the exit code for main().
+int headless_run(const options* opts, engine* sim);
+
+// Where the checkpoint of generation goes. They're named after --out,
+// "result.gol" saves "result-1000.gol" and so on. Without --out they're
+// "checkpoint-1000.gol".
+void headless_checkpoint_path(const options* opts, uint64_t generation, char* path, size_t size);
+
+#endif
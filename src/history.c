@@ -0,0 +1,289 @@
+/* history.c - Generation history
+*/
+
+#include <stdlib.h>
+#include "history.h"
+
+typedef struct
+{
+    uint64_t generation;
+
+    // Live cells in the grid, and how many cells were born and died since
+    // the generation recorded before it, if the engine knew
+    uint64_t population;
+    uint64_t births;
+    uint64_t deaths;
+    int changes;
+
+    // Rows of (width + 7) / 8 bytes, NULL until the slot is first used
+    uint8_t* bits;
+} frame;
+
+struct history
+{
+    int width;
+    int height;
+    size_t row_bytes;
+
+    frame* frames;
+    int capacity;
+
+    // Slot of the oldest generation, how many there are and which one is on
+    // screen, the last two counted from the oldest
+    int start;
+    int count;
+    int cursor;
+
+    // The engine's census when the last generation was recorded, births
+    // and deaths of the next one are counted from there
+    census last;
+    int last_changes;
+
+    // What history_keep() kept, which is the frame in slot kept_slot while
+    // that's still in the ring. Right before that slot gets recorded over,
+    // its bits are swapped into kept instead, and kept_slot becomes -1.
+    int has_kept;
+    int kept_slot;
+    frame kept;
+};
+
+int history_fit(int width, int height, int capacity, size_t budget)
+{
+    size_t bytes = (((size_t)width + 7) / 8) * height;
+    size_t fit = budget / bytes;
+
+    // One more can end up kept for history_keep()
+    fit = fit > 0 ? fit - 1 : 0;
+
+    return fit < (size_t)capacity ? (int)fit : capacity;
+}
+
+history* history_create(int width, int height, int capacity)
+{
+    if (capacity < 0)
+        return NULL;
+
+    history* h = calloc(1, sizeof(history));
+    if (!h)
+        return NULL;
+
+    h->width = width;
+    h->height = height;
+    h->row_bytes = ((size_t)width + 7) / 8;
+    h->capacity = capacity;
+    h->kept_slot = -1;
+    h->frames = calloc(capacity > 0 ? capacity : 1, sizeof(frame));
+
+    if (!h->frames)
+    {
+        history_destroy(h);
+        return NULL;
+    }
+
+    return h;
+}
+
+void history_destroy(history* h)
+{
+    if (!h)
+        return;
+
+    for (int i = 0; h->frames && i < h->capacity; i++)
+    {
+        free(h->frames[i].bits);
+    }
+
+    free(h->frames);
+    free(h->kept.bits);
+    free(h);
+}
+
+static frame* slot(const history* h, int index)
+{
+    return &h->frames[(h->start + index) % h->capacity];
+}
+
+int history_record(history* h, engine* e)
+{
+    // Nowhere to put it, which is fine
+    if (h->capacity == 0)
+        return 1;
+
+    // Anything after the cursor was undone, and this replaces it
+    h->count = h->count > 0 ? h->cursor + 1 : 0;
+
+    if (h->count == h->capacity)
+    {
+        h->start = (h->start + 1) % h->capacity;
+        h->count--;
+    }
+
+    frame* f = slot(h, h->count);
+
+    // Don't lose the kept generation, the slot gets the buffer that was
+    // spare instead (if there was one)
+    if (f - h->frames == h->kept_slot)
+    {
+        uint8_t* spare = h->kept.bits;
+
+        h->kept = *f;
+        f->bits = spare;
+        h->kept_slot = -1;
+    }
+
+    if (!f->bits)
+    {
+        f->bits = malloc(h->row_bytes * h->height);
+        if (!f->bits)
+        {
+            h->cursor = h->count > 0 ? h->count - 1 : 0;
+            return 0;
+        }
+    }
+
+    uint64_t population = 0;
+
+    for (int y = 0; y < h->height; y++)
+    {
+        population += engine_get_row_bits(e, y, &f->bits[h->row_bytes * y], h->width);
+    }
+
+    // Births and deaths only go up when the engine steps, so going back and
+    // recording over newer generations doesn't throw this off
+    census now;
+    int changes = engine_census(e, &now);
+
+    f->generation = e->generation;
+    f->population = population;
+    f->changes = changes && h->last_changes;
+    f->births = f->changes ? now.births - h->last.births : 0;
+    f->deaths = f->changes ? now.deaths - h->last.deaths : 0;
+
+    h->last = now;
+    h->last_changes = changes;
+    h->cursor = h->count;
+    h->count++;
+
+    return 1;
+}
+
+int history_keep(history* h, engine* e)
+{
+    if (h->count > 0)
+    {
+        h->has_kept = 1;
+        h->kept_slot = (int)(slot(h, h->cursor) - h->frames);
+        return 1;
+    }
+
+    if (!h->kept.bits)
+    {
+        h->kept.bits = malloc(h->row_bytes * h->height);
+        if (!h->kept.bits)
+        {
+            h->has_kept = 0;
+            return 0;
+        }
+    }
+
+    for (int y = 0; y < h->height; y++)
+    {
+        engine_get_row_bits(e, y, &h->kept.bits[h->row_bytes * y], h->width);
+    }
+
+    h->kept.generation = e->generation;
+    h->has_kept = 1;
+    h->kept_slot = -1;
+    return 1;
+}
+
+const uint8_t* history_kept(const history* h, uint64_t* generation)
+{
+    if (!h->has_kept)
+        return NULL;
+
+    const frame* f = h->kept_slot >= 0 ? &h->frames[h->kept_slot] : &h->kept;
+
+    *generation = f->generation;
+    return f->bits;
+}
+
+static void restore(const history* h, engine* e)
+{
+    const frame* f = slot(h, h->cursor);
+
+    e->clear(e);
+
+    for (int y = 0; y < h->height; y++)
+    {
+        engine_load_row_bits(e, y, &f->bits[h->row_bytes * y], h->width);
+    }
+
+    e->generation = f->generation;
+}
+
+int history_back(history* h, engine* e)
+{
+    if (h->cursor == 0 || h->count == 0)
+        return 0;
+
+    h->cursor--;
+    restore(h, e);
+    return 1;
+}
+
+int history_forward(history* h, engine* e)
+{
+    if (h->cursor + 1 >= h->count)
+        return 0;
+
+    h->cursor++;
+    restore(h, e);
+    return 1;
+}
+
+uint64_t history_population(const history* h)
+{
+    return h->count > 0 ? slot(h, h->cursor)->population : 0;
+}
+
+int history_changes(const history* h, uint64_t* births, uint64_t* deaths)
+{
+    if (h->count == 0 || !slot(h, h->cursor)->changes)
+        return 0;
+
+    *births = slot(h, h->cursor)->births;
+    *deaths = slot(h, h->cursor)->deaths;
+    return 1;
+}
+
+int history_count(const history* h)
+{
+    return h->count;
+}
+
+int history_cursor(const history* h)
+{
+    return h->cursor;
+}
+
+size_t history_memory(const history* h)
+{
+    size_t used = sizeof(history) + sizeof(frame) * h->capacity;
+
+    for (int i = 0; i < h->capacity; i++)
+    {
+        if (h->frames[i].bits)
+            used += h->row_bytes * h->height;
+    }
+
+    if (h->kept.bits)
+        used += h->row_bytes * h->height;
+
+    return used;
+}
+
+size_t history_max_memory(const history* h)
+{
+    return sizeof(history) + sizeof(frame) * h->capacity + h->row_bytes * h->height * (h->capacity + 1);
+}
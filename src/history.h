@@ -0,0 +1,77 @@
+/* history.h - Generation history
+ *
+ * Remembers the last few generations so the simulation can be stepped
+ * backwards. Every generation is stored bit-packed, one bit per cell, in a
+ * ring that drops the oldest one once it's full, so going back to any of
+ * them is just copying it back into the engine, no matter how far back it
+ * is. Memory for a generation is only allocated the first time it's used,
+ * and the rows are copied out already packed (see get_row_bits in engine.h)
+ * so recording one costs about as much as a memcpy of them.
+ *
+ * There's a cursor pointing at the generation on screen. Going back and
+ * forward only moves the cursor, and recording a new generation throws away
+ * everything after it.
+ *
+ * One generation can also be kept for saving later, which stays around
+ * even once it falls out of the ring. While it's still in there, it takes
+ * no memory of its own.
+ *
+ * Every generation also remembers its population and, if the engine counts
+ * them (see engine_census()), how many cells were born and died getting
+ * there, so they can be shown while stepping through.
+*/
+
+#ifndef HISTORY_H
+#define HISTORY_H
+
+#include <stddef.h>
+#include "engine.h"
+
+typedef struct history history;
+
+// How many of capacity generations of a width x height grid fit into budget
+// bytes, with one more left over for history_keep(). That's less for big
+// grids and can be 0 if there's only room for the kept one.
+int history_fit(int width, int height, int capacity, size_t budget);
+
+// Keep up to capacity generations of a width x height grid. With capacity 0
+// nothing is recorded and there's only history_keep(). Returns NULL if
+// there's no memory.
+history* history_create(int width, int height, int capacity);
+void history_destroy(history* h);
+
+// Record the engine's current generation after the cursor, and move the
+// cursor to it. Returns 0 if there wasn't enough memory for it.
+int history_record(history* h, engine* e);
+
+// Keep the engine's current generation for history_kept(), until this is
+// called again. If anything was recorded, that's the one at the cursor, so
+// record any changes first. Returns 0 if there wasn't enough memory for it.
+int history_keep(history* h, engine* e);
+
+// Rows of (width + 7) / 8 bytes of the kept generation, cell x of a row
+// being bit (x % 8) of byte (x / 8), or NULL if nothing was kept
+const uint8_t* history_kept(const history* h, uint64_t* generation);
+
+// Move the cursor one generation back or forward and copy that generation
+// into the engine. Returns 0 if there's nothing there.
+int history_back(history* h, engine* e);
+int history_forward(history* h, engine* e);
+
+// How many cells are alive in the grid at the cursor
+uint64_t history_population(const history* h);
+
+// How many cells were born and died between the generation recorded before
+// the cursor and the one at it. Returns 0 if the engine didn't count them.
+int history_changes(const history* h, uint64_t* births, uint64_t* deaths);
+
+// Generations stored, and where the cursor is (0 is the oldest)
+int history_count(const history* h);
+int history_cursor(const history* h);
+
+// Bytes used right now, and the most it will ever use, the kept generation
+// included
+size_t history_memory(const history* h);
+size_t history_max_memory(const history* h);
+
+#endif
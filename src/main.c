@@ -1,411 +1,755 @@
-/* main.c - Game of Life
- *
- * Game of Life Simulation, created with C and SDL
- * Made by - OmegaLol21
- *
- * This is a simulation of John Conway's Game of Life written in C.
- * This program is able to do the following:
- *  - Simulate cells living and dying
- *  - Pause and start a simulation
- *  - Select cells to live/die before starting a simulation
- *  - Able to save a simulation state into a file, and load a custom
- *    simulation as well.
- *  - Use the SDL backend
- *  - Change the speed of the simulation
- *  - Uses https://github.com/btzy/nativefiledialog-extended for
- *    file browsing dialogs
- *  - Cross platform!
-*/
-
-#include <SDL2/SDL.h>
-#include <stdio.h>
-#include <stdlib.h>
-#include <stdint.h>
-#include <nfd.h>
-
-// Bit locations, each cell will be stored in a 8 bit integer.
-// Starting from the least significant bit
-// 0 - Cell is alive and well
-// 1 - Cell will be revived next tick
-// 2 - Cell will die next tick
-#define CELL_ALIVE 0x1
-#define CELL_REVIVE 0x2
-#define CELL_DIE 0x4
-
-// 720p
-#define WINDOW_WIDTH 1280
-#define WINDOW_HEIGHT 720
-
-// How big the grid is in pixels
-#define PIXEL_SIZE 5
-
-// 144p
-#define GRID_WIDTH 256
-#define GRID_HEIGHT 144
-
-// Define booleans since C does not have booleans
-#define bool int
-#define true 1
-#define false 0
-
-// Create custom buttons for saving
-const SDL_MessageBoxButtonData save_buttons[] =
-{
-    { 0, 0, "Previous" },
-    { 0, 1, "Current" }
-};
-
-const SDL_MessageBoxButtonData yesno_buttons[] =
-{
-    { SDL_MESSAGEBOX_BUTTON_RETURNKEY_DEFAULT, 0, "No" },
-    { SDL_MESSAGEBOX_BUTTON_ESCAPEKEY_DEFAULT, 1, "Yes" }
-};
-
-// Create message box for saving/loading
-const SDL_MessageBoxData save_msg_data =
-{
-    SDL_MESSAGEBOX_INFORMATION,
-    NULL,
-    "Saving",
-    "Would you like to save the current or previous state?",
-    SDL_arraysize(save_buttons),
-    save_buttons,
-    NULL
-};
-
-// Allocate memory for the cell grid and screen buffer
-uint8_t cells[GRID_WIDTH * GRID_HEIGHT];
-uint32_t buffer[WINDOW_WIDTH * WINDOW_HEIGHT];
-
-uint8_t previous_simul[GRID_WIDTH * GRID_HEIGHT];
-
-int main(int argc, char** argv)
-{
-    // If SDL is unable to initialize, return
-    if (SDL_Init(SDL_INIT_EVERYTHING))
-    {
-        return -1;
-    }
-
-    // Simulation state
-    bool s_started = false;
-
-    // This is used to track how fast the simulation is going.
-    // The speed can be changed with the scroll wheel
-    int tick = 0;
-    int max_tick = 1;
-
-    // Initialize SDL windows, renderers, buffers, etc
-    SDL_Window* window = SDL_CreateWindow("Game of Life", SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED, WINDOW_WIDTH, WINDOW_HEIGHT, SDL_WINDOW_SHOWN);
-    SDL_Renderer* renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC);
-    SDL_Texture* window_buffer = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STREAMING, WINDOW_WIDTH, WINDOW_HEIGHT);
-
-    NFD_Init();
-
-    SDL_Event event;
-
-    SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
-    SDL_RenderClear(renderer);
-
-    // Drawing to the screen will be done by indirectly modifying the screen buffer.
-    // We are creating a texture with streaming access, window_buffer, so that way we can change
-    // the pixels in the texture individually. The buffer is the screen data, which
-    // we copy to the window_buffer which then we copy to the renderer, which
-    // renders the data.
-
-    bool quit = false;
-
-    // Might not be needed
-    bool uselocktexture = false;
-
-    // Keep track if the mouse buttons are down or up
-    bool add_btn_down = false;
-    bool rem_btn_down = false;
-    
-    // Main window loop
-    while (!quit)
-    {
-        // Process events
-        while (SDL_PollEvent(&event))
-        {
-            switch (event.type)
-            {
-            case SDL_QUIT:
-                quit = true;
-                break;
-            case SDL_KEYUP:
-                // If key pressed is F1, start/stop simulation
-                if (event.key.keysym.sym == SDLK_F1)
-                {
-                    s_started = !s_started;
-
-                    // Save the current state, so we can save it to a file later
-                    // if we so choose
-                    if (s_started)
-                    {
-                        memcpy(previous_simul, cells, sizeof(cells));
-                    }
-                }
-                else if (!s_started)
-                {
-                    // If key is F2, and the simulation hasnt started, clear all the cells
-                    if (event.key.keysym.sym == SDLK_F2)
-                    {
-                        for (int i = 0; i < GRID_WIDTH * GRID_HEIGHT; i++)
-                        {
-                            cells[i] = 0;
-                        }
-                    }
-                    else if (event.key.keysym.sym == SDLK_F3)
-                    {
-                        // Ask user if they want to save the previous or current state
-                        int btn;
-                        
-                        if (SDL_ShowMessageBox(&save_msg_data, &btn) < 0)
-                        {
-                            printf("Unable to display message box!\n");
-                        }
-                        else
-                        {
-                            // If saving current state, ask where to save it
-                            nfdchar_t *save_path = NULL;
-                            nfdfilteritem_t filter_items[1] = { { "Game of Life Simulation", "gol" } };
-                            nfdresult_t result = NFD_SaveDialog(&save_path, filter_items, 1, NULL, "Simulation");
-
-                            if (result == NFD_OKAY)
-                            {
-                                // Create/open the file
-                                FILE *fp = fopen(save_path, "w+b");
-
-                                // Write either the previous or current state, depending on what the
-                                // user chose.
-                                if (btn == 1)
-                                    fwrite(cells, sizeof(uint8_t), sizeof(cells) / sizeof(uint8_t), fp);
-                                else
-                                    fwrite(previous_simul, sizeof(uint8_t), sizeof(previous_simul) / sizeof(uint8_t), fp);
-
-                                // Close it to prevent any issues
-                                fclose(fp);
-                            }
-                            
-                            NFD_FreePath(save_path);
-                        }
-                    }
-
-                    else if (event.key.keysym.sym == SDLK_F4)
-                    {
-                        // Create the dialog
-                        nfdchar_t *simul_path = NULL;
-                        nfdfilteritem_t filter_items[1] = { { "Game of Life Simulation", "gol" } };
-                        nfdresult_t result = NFD_OpenDialog(&simul_path, filter_items, 1, NULL);
-
-                        if (result == NFD_OKAY)
-                        {
-                            // Open the file, load the contents into cells, and close the file
-                            FILE *fp = fopen(simul_path, "rb");
-
-                            fread(cells, sizeof(uint32_t), sizeof(cells) / sizeof(uint32_t), fp);
-
-                            fclose(fp);
-                        }
-                    }
-                    else if (event.key.keysym.sym == SDLK_F5)
-                    {
-                        // Show help for the game
-                        SDL_ShowSimpleMessageBox(SDL_MESSAGEBOX_INFORMATION, "Help", "F1 - Pause/start the simulation\nF2 - Clear the entire screen\nF3 - Save simulation to a file\nF4 - Load simulation from a file\n\nLeft Mouse - Draw cell\nRight Mouse - Remove cell\n\nScroll Wheel Up - Increase simulation speed\nScroll Wheel Down - Decrease simulation speed", window);
-                    }
-                }
-                break;
-            case SDL_MOUSEBUTTONDOWN:
-                // If buttons are down, set their respective state true
-                if (event.button.button == SDL_BUTTON_LEFT)
-                {
-                    add_btn_down = true;
-                }
-                else if (event.button.button == SDL_BUTTON_RIGHT)
-                {
-                    rem_btn_down = true;
-                }
-                break;
-            case SDL_MOUSEBUTTONUP:
-                // If buttons are up, set their respective state false
-                if (event.button.button == SDL_BUTTON_LEFT)
-                {
-                    add_btn_down = false;
-                }
-                else if (event.button.button == SDL_BUTTON_RIGHT)
-                {
-                    rem_btn_down = false;
-                }
-                break;
-            case SDL_MOUSEWHEEL:
-                // Mouse wheel up
-                if (event.wheel.y < 0)
-                {
-                    // Increase speed
-                    max_tick++;
-                }
-                // Mouse wheel down
-                else if (event.wheel.y > 0)
-                {
-                    // Decrease speed, prevent it from going negative
-                    max_tick--;
-
-                    if (max_tick <= 0)
-                    {
-                        max_tick = 1;
-                    }
-                }
-                break;
-            }
-        }
-
-        // Draw every cell if it is alive. Each cell is 5x5 pixels
-        for (int i = 0; i < GRID_WIDTH * GRID_HEIGHT; i++)
-        {
-            int cx = (i % GRID_WIDTH) * PIXEL_SIZE;
-            int cy = (i / GRID_WIDTH) * PIXEL_SIZE;
-
-            for (int x = cx; x < cx + PIXEL_SIZE; x++)
-            {
-                for (int y = cy; y < cy + PIXEL_SIZE; y++)
-                {
-                    if (cells[i] & CELL_ALIVE)
-                    {
-                        buffer[x + WINDOW_WIDTH * y] = UINT32_MAX;
-                    }
-                    else
-                    {
-                        buffer[(x + WINDOW_WIDTH * y)] = 0;
-                    }
-                }
-            }
-        }
-
-        // Draw cells if buttons are pressed
-        if (!s_started)
-        {   
-            // Get x, y pos
-            int x, y;
-            SDL_GetMouseState(&x, &y);
-
-            // Get grid position from window position
-            int cx, cy;
-            cx = (x / PIXEL_SIZE);
-            cy = (y / PIXEL_SIZE);
-
-            if (add_btn_down)
-            {
-                // Draw cells if the left mouse button is pressed
-                cells[cx + GRID_WIDTH * cy] = CELL_ALIVE;
-            }
-            else if (rem_btn_down)
-            {
-                // Delete cells if the right mouse button is presesd
-                cells[cx + GRID_WIDTH * cy] = 0;
-            }
-        }
-
-        // Update simulation
-        if (s_started)
-        {
-            // Used for setting simulation speed
-            if (tick > max_tick)
-            {
-                // Looping through each cell
-                for (int y = 0; y < GRID_HEIGHT; y++)
-                {
-                    for (int x = 0; x < GRID_WIDTH; x++)
-                    {
-                        uint8_t live_neighbors = 0;
-
-                        // Check for any live neighbors, if any.
-                        // The reason for a lot of if statements is for border-checking
-                        if (x != 0 && y != 0)
-                            if (cells[(x - 1) + GRID_WIDTH * (y - 1)] & CELL_ALIVE) live_neighbors++;
-                        if (y != 0)
-                            if (cells[(x) + GRID_WIDTH * (y - 1)] & CELL_ALIVE) live_neighbors++;
-                        if (y != 0 && x != GRID_WIDTH - 1)
-                            if (cells[(x + 1) + GRID_WIDTH * (y - 1)] & CELL_ALIVE) live_neighbors++;
-
-                        if (x != 0)
-                            if (cells[(x - 1) + GRID_WIDTH * (y)] & CELL_ALIVE) live_neighbors++;
-                        if (x != GRID_WIDTH - 1)
-                            if (cells[(x + 1) + GRID_WIDTH * (y)] & CELL_ALIVE) live_neighbors++;
-
-                        if (x != 0 && y != GRID_HEIGHT - 1)
-                            if (cells[(x - 1) + GRID_WIDTH * (y + 1)] & CELL_ALIVE) live_neighbors++;
-                        if (y != GRID_HEIGHT - 1)
-                            if (cells[(x) + GRID_WIDTH * (y + 1)] & CELL_ALIVE) live_neighbors++;
-                        if (x != GRID_WIDTH - 1 && y != GRID_HEIGHT - 1)
-                            if (cells[(x + 1) + GRID_WIDTH * (y + 1)] & CELL_ALIVE) live_neighbors++;
-
-                        // If there are 3 neighbors around current cell, is revived
-                        // If there are 2 neighbors, and the cell is alive, cell is healthy
-                        if (live_neighbors == 2 || live_neighbors == 3)
-                        {
-                            if (cells[x + GRID_WIDTH * y] & CELL_ALIVE)
-                            {
-                                continue;
-                            }
-
-                            if (live_neighbors == 3)
-                            {
-                                cells[x + GRID_WIDTH * y] |= CELL_REVIVE;
-                            }
-                        }
-                        // Die of under/over population
-                        else
-                        {
-                            cells[x + GRID_WIDTH * y] |= CELL_DIE;
-                        }
-                    }
-                }
-
-                // Update cells
-                for (int y = 0; y < GRID_HEIGHT; y++)
-                {
-                    for (int x = 0; x < GRID_WIDTH; x++)
-                    {
-                        if (cells[x + GRID_WIDTH * y] & CELL_REVIVE)
-                        {
-                            cells[x + GRID_WIDTH * y] = CELL_ALIVE;
-                        }
-                        else if (cells[x + GRID_WIDTH * y] & CELL_DIE)
-                        {
-                            cells[x + GRID_WIDTH * y] = 0;
-                        }
-                    }
-                }
-
-                // Reset ticks
-                tick = 0;
-            }
-        }
-
-        // Copy the screen buffer to the window buffer
-        uint32_t* locked_pixels;
-        int pitch;
-
-        SDL_LockTexture(window_buffer, NULL, (void**)&locked_pixels, &pitch);
-        SDL_memcpy(locked_pixels, buffer, WINDOW_WIDTH * WINDOW_HEIGHT * 4);
-        SDL_UnlockTexture(window_buffer);
-
-        // Copy the window buffer to the renderer to render it
-        SDL_RenderCopy(renderer, window_buffer, NULL, NULL);
-        SDL_RenderPresent(renderer);
-        
-        // Finally, update ticks
-        tick++;
-    }
-
-    // Clean up
-    SDL_DestroyTexture(window_buffer);
-    SDL_DestroyRenderer(renderer);
-    SDL_DestroyWindow(window);
-    SDL_Quit();
-
-    NFD_Quit();
-
-    return 0;
+/* main.c - Game of Life
+ *
+ * Game of Life Simulation, created with C and SDL
+ * Made by - OmegaLol21
+ *
+ * This is a simulation of John Conway's Game of Life written in C.
+ * This program is able to do the following:
+ *  - Simulate cells living and dying
+ *  - Pause and start a simulation
+ *  - Select cells to live/die before starting a simulation
+ *  - Able to save a simulation state into a file, and load a custom
+ *    simulation as well.
+ *  - Use the SDL backend
+ *  - Pick between a few different simulation engines (see engine.h)
+ *  - Pick the grid size from the command line (see options.h)
+ *  - Step the simulation on multiple threads
+ *  - Step on a thread of its own while drawing (--pipeline)
+ *  - Run without a window for a set number of generations (--headless)
+ *  - Split a headless run across threads or MPI processes (--ranks, --mpi)
+ *  - Run lots of random soups until they settle (--ensemble)
+ *  - Only redraw the parts of the screen that changed
+ *  - Move around and zoom in and out of grids bigger than the window
+ *  - Benchmark all the engines (--bench)
+ *  - Embed the simulation in other programs as libgol (see gol.h)
+ *  - Show where each frame's time goes (F6)
+ *  - Change the speed of the simulation
+ *  - Uses https://github.com/btzy/nativefiledialog-extended for
+ *    file browsing dialogs
+ *  - Cross platform!
+*/
+
+#include <SDL2/SDL.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <nfd.h>
+#include "engine.h"
+#include "options.h"
+#include "savefile.h"
+#include "pattern.h"
+#include "saver.h"
+#include "history.h"
+#include "headless.h"
+#include "bench.h"
+#include "scheduler.h"
+#include "render.h"
+#include "overlay.h"
+#include "pipeline.h"
+#include "distrib.h"
+#include "ensemble.h"
+#include "strokes.h"
+
+// How long stepping is allowed to take every frame, in seconds. This leaves
+// some room for drawing before the next 60 Hz VSync
+#define FRAME_BUDGET 0.012
+
+// Arrow keys move the view by this much of the window
+#define PAN_FRACTION 8
+
+// Define booleans since C does not have booleans
+#define bool int
+#define true 1
+#define false 0
+
+// Create custom buttons for saving
+const SDL_MessageBoxButtonData save_buttons[] =
+{
+    { 0, 0, "Previous" },
+    { 0, 1, "Current" }
+};
+
+const SDL_MessageBoxButtonData yesno_buttons[] =
+{
+    { SDL_MESSAGEBOX_BUTTON_RETURNKEY_DEFAULT, 0, "No" },
+    { SDL_MESSAGEBOX_BUTTON_ESCAPEKEY_DEFAULT, 1, "Yes" }
+};
+
+// Create message box for saving/loading
+const SDL_MessageBoxData save_msg_data =
+{
+    SDL_MESSAGEBOX_INFORMATION,
+    NULL,
+    "Saving",
+    "Would you like to save the current or previous state?",
+    SDL_arraysize(save_buttons),
+    save_buttons,
+    NULL
+};
+
+// Put the simulation speed in the window title
+static void show_speed(SDL_Window* window, const scheduler* speed)
+{
+    char title[64];
+
+    if (speed->rate == 0)
+        snprintf(title, sizeof(title), "Game of Life - Unlimited speed");
+    else if (speed->jump > 1)
+        snprintf(title, sizeof(title), "Game of Life - %d steps/s of %llu generations", speed->rate, (unsigned long long)speed->jump);
+    else
+        snprintf(title, sizeof(title), "Game of Life - %d generations/s", speed->rate);
+
+    SDL_SetWindowTitle(window, title);
+}
+
+// Put where we are in the history in the window title, while stepping
+// through it
+static void show_history(SDL_Window* window, const history* past, const engine* sim)
+{
+    char title[192];
+
+    int length = snprintf(title, sizeof(title), "Game of Life - Generation %llu, %d of %d in history (%.1f MB) - %llu alive",
+        (unsigned long long)sim->generation, history_cursor(past) + 1, history_count(past),
+        history_memory(past) / (1024.0 * 1024.0), (unsigned long long)history_population(past));
+
+    uint64_t births, deaths;
+
+    if (history_changes(past, &births, &deaths) && length > 0 && (size_t)length < sizeof(title))
+    {
+        snprintf(title + length, sizeof(title) - length, ", %llu born, %llu died",
+            (unsigned long long)births, (unsigned long long)deaths);
+    }
+
+    SDL_SetWindowTitle(window, title);
+}
+
+int main(int argc, char** argv)
+{
+    options opts;
+
+    if (!options_parse(&opts, argc, argv))
+    {
+        return -1;
+    }
+
+    if (opts.bench)
+    {
+        return bench_run(&opts);
+    }
+
+    // Every soup gets an engine of its own
+    if (opts.ensemble)
+    {
+        return ensemble_run(&opts);
+    }
+
+    // Every rank makes an engine of its own for its part of the grid
+    if (opts.ranks > 1 || opts.mpi)
+    {
+        return distrib_run(&opts);
+    }
+
+    const int grid_width = opts.width;
+    const int grid_height = opts.height;
+
+    engine* sim = engine_create(opts.engine, grid_width, grid_height);
+
+    if (!sim)
+    {
+        printf("Unable to create a %dx%d grid with the \"%s\" engine!\n", grid_width, grid_height, opts.engine);
+        return -1;
+    }
+
+    if (!engine_set_wrap(sim, opts.wrap))
+    {
+        printf("The \"%s\" engine can't wrap around at the edges!\n", opts.engine);
+        return -1;
+    }
+
+    if (!engine_set_rule(sim, &opts.rule))
+    {
+        printf("The \"%s\" engine can only run B3/S23!\n", opts.engine);
+        return -1;
+    }
+
+    // Only bother with a thread pool if there is more than one thread
+    workers* pool = NULL;
+
+    if (opts.threads != 1)
+    {
+        pool = workers_create(opts.threads);
+
+        if (!pool)
+        {
+            printf("Unable to start %d worker threads!\n", opts.threads);
+            return -1;
+        }
+
+        sim->pool = pool;
+    }
+
+    // The GPU engine's context can only be used by one thread at a time, and
+    // it doesn't leave the CPU anything to overlap with anyway
+    if (opts.pipeline && sim->texture)
+    {
+        printf("The \"%s\" engine can't step on a thread of its own, leave out --pipeline\n", opts.engine);
+        return -1;
+    }
+
+    // Headless mode never opens a window, so everything past here is skipped
+    if (opts.headless)
+    {
+        int result = headless_run(&opts, sim);
+
+        sim->destroy(sim);
+        workers_destroy(pool);
+
+        return result;
+    }
+
+    if (opts.in && !pattern_load(opts.in, sim, opts.offset_x, opts.offset_y))
+    {
+        printf("Unable to load %s!\n", opts.in);
+        return -1;
+    }
+
+    const int pixel_size = opts.pixel_size;
+
+    // Just big enough for the grid, unless that's too big. The view takes
+    // care of grids that don't fit.
+    long long fit_width = (long long)grid_width * pixel_size;
+    long long fit_height = (long long)grid_height * pixel_size;
+
+    const int window_width = opts.window_width ? opts.window_width : (int)(fit_width < DEFAULT_MAX_WINDOW_WIDTH ? fit_width : DEFAULT_MAX_WINDOW_WIDTH);
+    const int window_height = opts.window_height ? opts.window_height : (int)(fit_height < DEFAULT_MAX_WINDOW_HEIGHT ? fit_height : DEFAULT_MAX_WINDOW_HEIGHT);
+
+    // If SDL is unable to initialize, return
+    if (SDL_Init(SDL_INIT_EVERYTHING))
+    {
+        return -1;
+    }
+
+    // Simulation state
+    bool s_started = false;
+
+    // This is used to track how fast the simulation is going, in generations
+    // per second. The speed can be changed with the scroll wheel
+    scheduler speed;
+    scheduler_init(&speed, SCHEDULER_DEFAULT_RATE, (uint64_t)1 << opts.jump);
+
+    // Initialize SDL windows, renderers, buffers, etc
+    Uint32 renderer_flags = SDL_RENDERER_ACCELERATED;
+
+    if (opts.vsync)
+    {
+        renderer_flags |= SDL_RENDERER_PRESENTVSYNC;
+    }
+
+    Uint32 window_flags = SDL_WINDOW_SHOWN;
+
+    // A grid on the GPU gets drawn from there, which takes SDL's OpenGL
+    // renderer in a context that shares textures with the engine's. The
+    // engine's context is the current one right now, that's what it gets
+    // shared with.
+    if (sim->texture)
+    {
+        SDL_SetHint(SDL_HINT_RENDER_DRIVER, "opengl");
+        SDL_GL_SetAttribute(SDL_GL_SHARE_WITH_CURRENT_CONTEXT, 1);
+        window_flags |= SDL_WINDOW_OPENGL;
+    }
+
+    SDL_Window* window = SDL_CreateWindow("Game of Life", SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED, window_width, window_height, window_flags);
+    SDL_Renderer* renderer = SDL_CreateRenderer(window, -1, renderer_flags);
+    render screen;
+
+    if (!window || !renderer || !render_init(&screen, renderer, sim, window_width, window_height, pixel_size, opts.gpu_scale))
+    {
+        printf("Unable to create a %dx%d window: %s\n", window_width, window_height, SDL_GetError());
+        return -1;
+    }
+
+    // Cells drawn with the mouse, which whoever is stepping draws into the
+    // engine between generations
+    strokes* paint = strokes_create();
+
+    if (!paint)
+    {
+        printf("Out of memory!\n");
+        return -1;
+    }
+
+    // With --pipeline the simulation steps on this thread while it's
+    // running, and the window only draws what it counted
+    pipeline* pipe = NULL;
+
+    if (opts.pipeline)
+    {
+        pipe = pipeline_create(sim, paint, (size_t)screen.width * screen.height, FRAME_BUDGET);
+
+        if (!pipe)
+        {
+            printf("Unable to start the simulation thread!\n");
+            return -1;
+        }
+    }
+
+    // F3 writes files on this thread, so the simulation doesn't stop for it
+    saver* background = saver_create();
+
+    if (!background)
+    {
+        printf("Unable to start the saving thread!\n");
+        return -1;
+    }
+
+    // The last few generations, to step back through while paused
+    history* past = NULL;
+
+    int generations = history_fit(grid_width, grid_height, opts.history, (size_t)opts.history_memory * 1024 * 1024);
+
+    if (opts.history > 0 && generations == 0)
+        printf("Not even one generation of a %dx%d grid fits into %d MB, there's no history\n", grid_width, grid_height, opts.history_memory);
+
+    if (generations > 0)
+    {
+        past = history_create(grid_width, grid_height, generations);
+
+        if (!past)
+        {
+            printf("Out of memory!\n");
+            return -1;
+        }
+
+        printf("Keeping %d generations of history, up to %.1f MB\n", generations, history_max_memory(past) / (1024.0 * 1024.0));
+
+        history_record(past, sim);
+        speed.record = past;
+    }
+
+    // Where the grid from when the simulation was last started is kept, to
+    // save it as the previous state. The history has it already if there is
+    // one, otherwise it's a copy of its own.
+    history* start = past ? past : history_create(grid_width, grid_height, 0);
+
+    if (!start || !history_keep(start, sim))
+    {
+        printf("Out of memory!\n");
+        return -1;
+    }
+
+    // Cells were changed by hand since the last generation got recorded
+    bool edited = false;
+
+    NFD_Init();
+
+    SDL_Event event;
+
+    show_speed(window, &speed);
+
+    // Frame timing, shown with F6
+    overlay timing;
+    overlay_init(&timing, sim->generation);
+
+    SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
+    SDL_RenderClear(renderer);
+
+    // Drawing to the screen is done in render.c
+
+    bool quit = false;
+
+    // Keep track if the mouse buttons are down or up
+    bool add_btn_down = false;
+    bool rem_btn_down = false;
+
+    // Which generation is on screen, and its census if there is one
+    uint64_t drawn = sim->generation;
+    census drawn_census;
+    int drawn_changes = 0;
+    bool counted = false;
+
+    // The grid changed since it was last painted in a way the generation
+    // doesn't show, like drawing, clearing or loading. Without that, a
+    // moved view or a new generation, there's nothing new to paint.
+    bool repaint = true;
+    
+    // Main window loop
+    while (!quit)
+    {
+        // Process events
+        while (SDL_PollEvent(&event))
+        {
+            switch (event.type)
+            {
+            case SDL_QUIT:
+                quit = true;
+                break;
+            case SDL_KEYUP:
+                // If key pressed is F1, start/stop simulation
+                if (event.key.keysym.sym == SDLK_F1)
+                {
+                    s_started = !s_started;
+
+                    // The last frame the simulation thread counted could be
+                    // behind what it did to the grid
+                    repaint = true;
+
+                    // Save the current state, so we can save it to a file later
+                    // if we so choose
+                    if (s_started)
+                    {
+                        if (past && edited)
+                            history_record(past, sim);
+
+                        history_keep(start, sim);
+
+                        edited = false;
+                        show_speed(window, &speed);
+
+                        if (pipe)
+                            pipeline_start(pipe, &speed);
+                    }
+                    else if (pipe)
+                    {
+                        // The engine is ours again once this returns
+                        pipeline_stop(pipe);
+                    }
+                }
+                else if (event.key.keysym.sym == SDLK_F6)
+                {
+                    timing.visible = !timing.visible;
+
+                    // So the census gets taken for it
+                    repaint = true;
+                }
+                // Saving works while running too, the grid gets copied and
+                // written in the background
+                else if (event.key.keysym.sym == SDLK_F3)
+                {
+                    // Ask user if they want to save the previous or current state
+                    int btn;
+                    
+                    if (SDL_ShowMessageBox(&save_msg_data, &btn) < 0)
+                    {
+                        printf("Unable to display message box!\n");
+                    }
+                    else
+                    {
+                        // If saving current state, ask where to save it
+                        nfdchar_t *save_path = NULL;
+                        nfdfilteritem_t filter_items[1] = { { "Game of Life Simulation", "gol" } };
+                        nfdresult_t result = NFD_SaveDialog(&save_path, filter_items, 1, NULL, "Simulation");
+
+                        if (result == NFD_OKAY)
+                        {
+                            // Write either the previous or current state, depending on what the
+                            // user chose. Whether it worked shows up once it's written.
+                            bool started;
+
+                            // Copying the grid needs the simulation thread
+                            // to hold still for a moment, and so does the
+                            // history it records into
+                            if (pipe && s_started)
+                                pipeline_stop(pipe);
+
+                            if (btn == 1)
+                                started = saver_save(background, sim, save_path);
+                            else
+                            {
+                                uint64_t generation;
+                                const uint8_t* bits = history_kept(start, &generation);
+
+                                started = saver_save_bits(background, bits, grid_width, grid_height, generation, save_path);
+                            }
+
+                            if (pipe && s_started)
+                                pipeline_start(pipe, &speed);
+
+                            if (!started)
+                            {
+                                SDL_ShowSimpleMessageBox(SDL_MESSAGEBOX_ERROR, "Saving", "Still saving the last file, try again in a bit!", window);
+                            }
+                        }
+                        
+                        NFD_FreePath(save_path);
+                    }
+                }
+                else if (!s_started)
+                {
+                    // If key is F2, and the simulation hasnt started, clear all the cells
+                    if (event.key.keysym.sym == SDLK_F2)
+                    {
+                        sim->clear(sim);
+                        sim->generation = 0;
+                        edited = true;
+                        repaint = true;
+                    }
+                    else if (event.key.keysym.sym == SDLK_F4)
+                    {
+                        // Create the dialog
+                        nfdchar_t *simul_path = NULL;
+                        nfdfilteritem_t filter_items[4] =
+                        {
+                            { "All patterns", "gol,rle,cells" },
+                            { "Game of Life Simulation", "gol" },
+                            { "Run Length Encoded pattern", "rle" },
+                            { "Plaintext pattern", "cells" }
+                        };
+                        nfdresult_t result = NFD_OpenDialog(&simul_path, filter_items, SDL_arraysize(filter_items), NULL);
+
+                        if (result == NFD_OKAY)
+                        {
+                            // Load the contents of the file into the simulation,
+                            // patterns go in the same place as with --in
+                            if (!pattern_load(simul_path, sim, opts.offset_x, opts.offset_y))
+                            {
+                                SDL_ShowSimpleMessageBox(SDL_MESSAGEBOX_ERROR, "Loading", "Unable to load the simulation!", window);
+                            }
+
+                            edited = true;
+                            repaint = true;
+
+                            NFD_FreePath(simul_path);
+                        }
+                    }
+                    else if (event.key.keysym.sym == SDLK_F5)
+                    {
+                        // Show help for the game
+                        SDL_ShowSimpleMessageBox(SDL_MESSAGEBOX_INFORMATION, "Help", "F1 - Pause/start the simulation\nF2 - Clear the entire screen\nF3 - Save simulation to a file\nF4 - Load a simulation or pattern from a file\nF6 - Show frame timing\n\nLeft/Right - Step back/forward while paused\n\nLeft Mouse - Draw cells\nRight Mouse - Remove cells\n\nScroll Wheel Up - Increase simulation speed\nScroll Wheel Down - Decrease simulation speed\n\nArrow keys or Middle Mouse drag - Move around\nShift + Left/Right - Move around while paused\nCtrl + Scroll Wheel, +/- - Zoom in/out\nHome - Zoom to fit the whole grid", window);
+                    }
+                }
+                break;
+            case SDL_KEYDOWN:
+                // Step through the history while paused. Holding the key down
+                // repeats, which scrubs through it. With Shift they move the
+                // view instead.
+                if (!s_started && past && (event.key.keysym.sym == SDLK_LEFT || event.key.keysym.sym == SDLK_RIGHT)
+                    && !(event.key.keysym.mod & KMOD_SHIFT))
+                {
+                    // Whatever was drawn by hand becomes the newest generation
+                    if (edited)
+                        history_record(past, sim);
+
+                    edited = false;
+
+                    if (event.key.keysym.sym == SDLK_LEFT)
+                    {
+                        history_back(past, sim);
+                    }
+                    else if (!history_forward(past, sim))
+                    {
+                        // Past the newest one, so step a new one
+                        engine_advance(sim, speed.jump);
+                        history_record(past, sim);
+                    }
+
+                    show_history(window, past, sim);
+                    repaint = true;
+                }
+                else if (event.key.keysym.sym == SDLK_LEFT)
+                {
+                    render_pan(&screen, -window_width / PAN_FRACTION, 0);
+                }
+                else if (event.key.keysym.sym == SDLK_RIGHT)
+                {
+                    render_pan(&screen, window_width / PAN_FRACTION, 0);
+                }
+                else if (event.key.keysym.sym == SDLK_UP)
+                {
+                    render_pan(&screen, 0, -window_height / PAN_FRACTION);
+                }
+                else if (event.key.keysym.sym == SDLK_DOWN)
+                {
+                    render_pan(&screen, 0, window_height / PAN_FRACTION);
+                }
+                // Zoom around the middle of the window
+                else if (event.key.keysym.sym == SDLK_EQUALS || event.key.keysym.sym == SDLK_PLUS || event.key.keysym.sym == SDLK_KP_PLUS)
+                {
+                    render_zoom(&screen, 1, window_width / 2, window_height / 2);
+                }
+                else if (event.key.keysym.sym == SDLK_MINUS || event.key.keysym.sym == SDLK_KP_MINUS)
+                {
+                    render_zoom(&screen, -1, window_width / 2, window_height / 2);
+                }
+                else if (event.key.keysym.sym == SDLK_HOME)
+                {
+                    render_fit(&screen);
+                }
+                break;
+            case SDL_MOUSEMOTION:
+                // Dragging with the middle button moves the view along with
+                // the mouse
+                if (event.motion.state & SDL_BUTTON_MMASK)
+                {
+                    render_pan(&screen, -event.motion.xrel, -event.motion.yrel);
+                }
+
+                // Every motion event while drawing is a line from the last
+                // one, so fast strokes don't leave gaps
+                if (add_btn_down || rem_btn_down)
+                {
+                    int cx, cy;
+                    render_cell_at(&screen, event.motion.x, event.motion.y, &cx, &cy);
+                    strokes_move(paint, cx, cy);
+                }
+                break;
+            case SDL_MOUSEBUTTONDOWN:
+                // Left draws cells and right removes them, whichever went
+                // down first wins until it comes back up
+                if ((event.button.button == SDL_BUTTON_LEFT || event.button.button == SDL_BUTTON_RIGHT)
+                    && !add_btn_down && !rem_btn_down)
+                {
+                    add_btn_down = event.button.button == SDL_BUTTON_LEFT;
+                    rem_btn_down = event.button.button == SDL_BUTTON_RIGHT;
+
+                    int cx, cy;
+                    render_cell_at(&screen, event.button.x, event.button.y, &cx, &cy);
+                    strokes_begin(paint, cx, cy, add_btn_down);
+                }
+                break;
+            case SDL_MOUSEBUTTONUP:
+                if ((event.button.button == SDL_BUTTON_LEFT && add_btn_down)
+                    || (event.button.button == SDL_BUTTON_RIGHT && rem_btn_down))
+                {
+                    add_btn_down = false;
+                    rem_btn_down = false;
+                    strokes_end(paint);
+                }
+                break;
+            case SDL_MOUSEWHEEL:
+                // With Ctrl held it zooms around the mouse instead
+                if (SDL_GetModState() & KMOD_CTRL)
+                {
+                    int x, y;
+                    SDL_GetMouseState(&x, &y);
+
+                    render_zoom(&screen, event.wheel.y, x, y);
+                }
+                // Mouse wheel up
+                else if (event.wheel.y > 0)
+                {
+                    // Increase speed
+                    scheduler_faster(&speed);
+                    show_speed(window, &speed);
+
+                    if (pipe)
+                        pipeline_set_rate(pipe, speed.rate);
+                }
+                // Mouse wheel down
+                else if (event.wheel.y < 0)
+                {
+                    // Decrease speed, it won't go below 1 generation per second
+                    scheduler_slower(&speed);
+                    show_speed(window, &speed);
+
+                    if (pipe)
+                        pipeline_set_rate(pipe, speed.rate);
+                }
+                break;
+            }
+        }
+
+        // Draw what the mouse drew. While the simulation thread has the
+        // engine it does that itself, it only needs to know there's more.
+        bool drew = strokes_flush(paint);
+
+        if (pipe && s_started)
+        {
+            if (drew)
+                pipeline_poke(pipe);
+        }
+        else if (strokes_apply(paint, sim) > 0)
+        {
+            edited = edited || !s_started;
+            repaint = true;
+        }
+
+        overlay_lap(&timing, OVERLAY_EVENTS);
+
+        // Update simulation. However many generations are due since the last
+        // frame get stepped, and only the newest one gets drawn. With
+        // --pipeline that happens on the simulation thread instead.
+        if (s_started && !pipe)
+        {
+            scheduler_run(&speed, sim, FRAME_BUDGET);
+        }
+        else if (!s_started)
+        {
+            scheduler_reset(&speed);
+        }
+
+        overlay_lap(&timing, OVERLAY_STEP);
+
+        int saved;
+
+        if (saver_finished(background, &saved) && !saved)
+        {
+            SDL_ShowSimpleMessageBox(SDL_MESSAGEBOX_ERROR, "Saving", "Unable to save the simulation!", window);
+        }
+
+        // Draw every cell that changed since the last frame. While the
+        // simulation thread has the engine, that's whatever it counted last,
+        // and the last frame stays up until it's counted something new.
+        if (pipe)
+        {
+            render_frame view;
+            render_view(&screen, &view);
+            pipeline_set_view(pipe, &view);
+        }
+
+        if (pipe && s_started)
+        {
+            const render_frame* latest = pipeline_latest(pipe);
+
+            if (latest && render_paint_frame(&screen, latest))
+            {
+                drawn = latest->generation;
+                drawn_census = latest->counted;
+                drawn_changes = latest->changes;
+                counted = true;
+            }
+        }
+        else if (repaint || screen.full || sim->generation != drawn)
+        {
+            render_paint(&screen, sim);
+            drawn = sim->generation;
+            repaint = false;
+
+            // Only start the engine counting once it's going to be shown
+            counted = timing.visible;
+
+            if (counted)
+                drawn_changes = engine_census(sim, &drawn_census);
+        }
+
+        overlay_lap(&timing, OVERLAY_PAINT);
+
+        render_upload(&screen);
+        overlay_draw(&timing, renderer, screen.population);
+        overlay_lap(&timing, OVERLAY_UPLOAD);
+
+        SDL_RenderPresent(renderer);
+        overlay_lap(&timing, OVERLAY_PRESENT);
+
+        overlay_frame(&timing, drawn, counted ? &drawn_census : NULL, drawn_changes);
+    }
+
+    // Clean up, anything still being saved gets finished first
+    pipeline_destroy(pipe);
+    strokes_destroy(paint);
+    saver_destroy(background);
+    if (start != past)
+        history_destroy(start);
+    history_destroy(past);
+    sim->destroy(sim);
+    workers_destroy(pool);
+
+    render_free(&screen);
+    SDL_DestroyRenderer(renderer);
+    SDL_DestroyWindow(window);
+    SDL_Quit();
+
+    NFD_Quit();
+
+    return 0;
 }
\ No newline at end of file
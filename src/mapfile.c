@@ -0,0 +1,112 @@
+/* mapfile.c - Read-only memory mapped files
+*/
+
+#include "mapfile.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+int mapfile_open(mapfile* m, const char* path)
+{
+    m->data = NULL;
+    m->size = 0;
+    m->mapping = NULL;
+    m->file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+
+    if (m->file == INVALID_HANDLE_VALUE)
+        return 0;
+
+    LARGE_INTEGER size;
+
+    if (!GetFileSizeEx(m->file, &size) || (unsigned long long)size.QuadPart > SIZE_MAX)
+    {
+        CloseHandle(m->file);
+        return 0;
+    }
+
+    // Empty files can't be mapped, but there's nothing to read anyway
+    if (size.QuadPart == 0)
+        return 1;
+
+    m->mapping = CreateFileMappingA(m->file, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (m->mapping)
+        m->data = MapViewOfFile(m->mapping, FILE_MAP_READ, 0, 0, 0);
+
+    if (!m->data)
+    {
+        mapfile_close(m);
+        return 0;
+    }
+
+    m->size = (size_t)size.QuadPart;
+    return 1;
+}
+
+void mapfile_close(mapfile* m)
+{
+    if (m->data)
+        UnmapViewOfFile(m->data);
+    if (m->mapping)
+        CloseHandle(m->mapping);
+
+    CloseHandle(m->file);
+    m->data = NULL;
+    m->size = 0;
+}
+#else
+int mapfile_open(mapfile* m, const char* path)
+{
+    m->data = NULL;
+    m->size = 0;
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+        return 0;
+
+    struct stat st;
+
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || (unsigned long long)st.st_size > SIZE_MAX)
+    {
+        close(fd);
+        return 0;
+    }
+
+    // Empty files can't be mapped, but there's nothing to read anyway
+    if (st.st_size == 0)
+    {
+        close(fd);
+        return 1;
+    }
+
+    void* data = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+    // The mapping keeps the file open by itself
+    close(fd);
+
+    if (data == MAP_FAILED)
+        return 0;
+
+    // Files get read front to back, so the OS can read ahead
+    madvise(data, (size_t)st.st_size, MADV_SEQUENTIAL);
+
+    m->data = data;
+    m->size = (size_t)st.st_size;
+    return 1;
+}
+
+void mapfile_close(mapfile* m)
+{
+    if (m->data)
+        munmap((void*)m->data, m->size);
+
+    m->data = NULL;
+    m->size = 0;
+}
+#endif
@@ -0,0 +1,31 @@
+/* mapfile.h - Read-only memory mapped files
+ *
+ * Maps a whole file into memory instead of reading it into a buffer. Pages
+ * only get loaded from disk when they're touched, and they come straight
+ * out of the OS file cache, so a huge file doesn't need a second copy of
+ * itself in memory.
+*/
+
+#ifndef MAPFILE_H
+#define MAPFILE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+typedef struct
+{
+    // The contents of the file, NULL if it's empty
+    const uint8_t* data;
+    size_t size;
+
+#ifdef _WIN32
+    void* file;
+    void* mapping;
+#endif
+} mapfile;
+
+// Map a file, returns 1 on success and 0 if it couldn't be opened or mapped
+int mapfile_open(mapfile* m, const char* path);
+void mapfile_close(mapfile* m);
+
+#endif
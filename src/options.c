@@ -0,0 +1,280 @@
+/* options.c - Command line options
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "options.h"
+#include "pattern.h"
+
+static void print_usage(const char* program)
+{
+    printf("Usage: %s [options]\n", program);
+    printf("  --engine NAME        Engine to step with: byte, bit, tile, hashlife, sparse or gpu (default bit)\n");
+    printf("  --width N            Grid width in cells (default %d)\n", DEFAULT_GRID_WIDTH);
+    printf("  --height N           Grid height in cells (default %d)\n", DEFAULT_GRID_HEIGHT);
+    printf("  --pixel-size N       Size of each cell on screen to start with (default %d)\n", DEFAULT_PIXEL_SIZE);
+    printf("  --window W,H         Window size in pixels (default the grid size, up to %dx%d)\n", DEFAULT_MAX_WINDOW_WIDTH, DEFAULT_MAX_WINDOW_HEIGHT);
+    printf("  --threads N          Threads to step with, 0 for one per core (default 1)\n");
+    printf("  --jump K             Every step in the window is 2^K generations (default 0)\n");
+    printf("  --in FILE            Load a .gol, .rle or .cells file before starting\n");
+    printf("  --offset X,Y         Put the top left of an .rle/.cells pattern here (default centered)\n");
+    printf("  --scale gpu|cpu      Who scales the grid up to the window (default gpu)\n");
+    printf("  --no-vsync           Draw frames as fast as possible\n");
+    printf("  --pipeline           Step on its own thread while drawing\n");
+    printf("  --rule RULE          Rule to run, like B36/S23 or highlife (default B3/S23)\n");
+    printf("  --wrap               Wrap around at the edges, not with hashlife or sparse\n");
+    printf("  --history N          Generations to keep for stepping back, 0 for none (default %d)\n", DEFAULT_HISTORY);
+    printf("  --history-memory MB  Most memory the history can use (default %d)\n", DEFAULT_HISTORY_MEMORY);
+    printf("\n");
+    printf("  --headless           Run without a window and quit when done\n");
+    printf("  --gens N             Generations to run in headless mode (default 1000)\n");
+    printf("  --out FILE           Save the final state to a .gol file in headless mode\n");
+    printf("  --checkpoint-every N Save a copy every N generations while running headless\n");
+    printf("  --detect-cycles      Report when the grid starts repeating in headless mode\n");
+    printf("  --stop-on-cycle      Same, and stop right there\n");
+    printf("  --stats FILE         Write timings and population to a CSV file in headless mode\n");
+    printf("  --stats-every N      Generations between lines in the CSV file (default 100)\n");
+    printf("  --ranks N            Split the grid into N blocks stepped on their own threads in headless mode\n");
+    printf("  --mpi                Split it across the processes started by mpirun instead (make mpi)\n");
+    printf("  --halo K             Trade K cells with the neighbouring blocks every K generations (default 1)\n");
+    printf("\n");
+    printf("  --ensemble FIRST,LAST Run a random soup for every seed in the range until it settles\n");
+    printf("  --density P          Percent of the cells alive in every soup (default 35)\n");
+    printf("  --jobs N             Soups to run at once, 0 for one per core (default 0)\n");
+    printf("\n");
+    printf("  --bench              Time every engine on a few random soups and quit\n");
+    printf("  --seed N             Seed for the benchmark soups (default 1)\n");
+}
+
+// Parse a whole argument as a number, and make sure it is at least min
+static int parse_int(const char* arg, int min, int* out)
+{
+    char* end;
+    long value = strtol(arg, &end, 10);
+
+    if (end == arg || *end != '\0' || value < min || value > 1 << 30)
+        return 0;
+
+    *out = (int)value;
+    return 1;
+}
+
+// Two numbers split by a comma, which can be negative
+static int parse_point(const char* arg, int* x, int* y)
+{
+    char* end;
+    long a = strtol(arg, &end, 10);
+
+    if (end == arg || *end != ',')
+        return 0;
+
+    const char* second = end + 1;
+    long b = strtol(second, &end, 10);
+
+    if (end == second || *end != '\0' || a < -(1 << 30) || a > 1 << 30 || b < -(1 << 30) || b > 1 << 30)
+        return 0;
+
+    *x = (int)a;
+    *y = (int)b;
+    return 1;
+}
+
+// Same as parse_int, for counts that can go past what an int holds
+static int parse_count(const char* arg, long long min, long long* out)
+{
+    char* end;
+    long long value = strtoll(arg, &end, 10);
+
+    if (end == arg || *end != '\0' || value < min)
+        return 0;
+
+    *out = value;
+    return 1;
+}
+
+// Two counts split by a comma, the second one at least the first one
+static int parse_range(const char* arg, long long* first, long long* last)
+{
+    char* end;
+    long long a = strtoll(arg, &end, 10);
+
+    if (end == arg || *end != ',' || a < 0)
+        return 0;
+
+    const char* second = end + 1;
+    long long b = strtoll(second, &end, 10);
+
+    if (end == second || *end != '\0' || b < a)
+        return 0;
+
+    *first = a;
+    *last = b;
+    return 1;
+}
+
+// A percentage from 0 to 100, as a fraction from 0 to 1
+static int parse_percent(const char* arg, double* out)
+{
+    char* end;
+    double value = strtod(arg, &end);
+
+    if (end == arg || *end != '\0' || !(value >= 0 && value <= 100))
+        return 0;
+
+    *out = value / 100;
+    return 1;
+}
+
+int options_parse(options* opts, int argc, char** argv)
+{
+    opts->engine = "bit";
+    opts->width = DEFAULT_GRID_WIDTH;
+    opts->height = DEFAULT_GRID_HEIGHT;
+    opts->pixel_size = DEFAULT_PIXEL_SIZE;
+    opts->window_width = 0;
+    opts->window_height = 0;
+    opts->threads = 1;
+    opts->jump = 0;
+    opts->gpu_scale = 1;
+    opts->vsync = 1;
+    opts->pipeline = 0;
+    opts->wrap = 0;
+    opts->rule = rule_life;
+    opts->history = DEFAULT_HISTORY;
+    opts->history_memory = DEFAULT_HISTORY_MEMORY;
+    opts->headless = 0;
+    opts->gens = 1000;
+    opts->in = NULL;
+    opts->offset_x = PATTERN_CENTER;
+    opts->offset_y = PATTERN_CENTER;
+    opts->out = NULL;
+    opts->checkpoint_every = 0;
+    opts->detect_cycles = 0;
+    opts->stop_on_cycle = 0;
+    opts->stats = NULL;
+    opts->stats_every = 100;
+    opts->ranks = 1;
+    opts->mpi = 0;
+    opts->halo = 1;
+    opts->ensemble = 0;
+    opts->first_seed = 0;
+    opts->last_seed = 0;
+    opts->density = 0.35;
+    opts->jobs = 0;
+    opts->bench = 0;
+    opts->seed = 1;
+
+    for (int i = 1; i < argc; i++)
+    {
+        // Flags first, they don't take a value
+        if (strcmp(argv[i], "--headless") == 0)
+        {
+            opts->headless = 1;
+            continue;
+        }
+        if (strcmp(argv[i], "--detect-cycles") == 0)
+        {
+            opts->detect_cycles = 1;
+            continue;
+        }
+        if (strcmp(argv[i], "--stop-on-cycle") == 0)
+        {
+            opts->detect_cycles = 1;
+            opts->stop_on_cycle = 1;
+            continue;
+        }
+        if (strcmp(argv[i], "--bench") == 0)
+        {
+            opts->bench = 1;
+            continue;
+        }
+        if (strcmp(argv[i], "--no-vsync") == 0)
+        {
+            opts->vsync = 0;
+            continue;
+        }
+        if (strcmp(argv[i], "--pipeline") == 0)
+        {
+            opts->pipeline = 1;
+            continue;
+        }
+        if (strcmp(argv[i], "--wrap") == 0)
+        {
+            opts->wrap = 1;
+            continue;
+        }
+        if (strcmp(argv[i], "--mpi") == 0)
+        {
+            opts->mpi = 1;
+            continue;
+        }
+
+        // Every other option takes a value
+        const char* value = i + 1 < argc ? argv[i + 1] : NULL;
+        int ok = value != NULL;
+
+        if (ok && strcmp(argv[i], "--engine") == 0)
+            opts->engine = value;
+        else if (ok && strcmp(argv[i], "--width") == 0)
+            ok = parse_int(value, 1, &opts->width);
+        else if (ok && strcmp(argv[i], "--height") == 0)
+            ok = parse_int(value, 1, &opts->height);
+        else if (ok && strcmp(argv[i], "--pixel-size") == 0)
+            ok = parse_int(value, 1, &opts->pixel_size);
+        else if (ok && strcmp(argv[i], "--window") == 0)
+            ok = parse_point(value, &opts->window_width, &opts->window_height) && opts->window_width > 0 && opts->window_height > 0;
+        else if (ok && strcmp(argv[i], "--threads") == 0)
+            ok = parse_int(value, 0, &opts->threads);
+        else if (ok && strcmp(argv[i], "--rule") == 0)
+            ok = rule_parse(value, &opts->rule);
+        else if (ok && strcmp(argv[i], "--history") == 0)
+            ok = parse_int(value, 0, &opts->history);
+        else if (ok && strcmp(argv[i], "--history-memory") == 0)
+            ok = parse_int(value, 1, &opts->history_memory);
+        else if (ok && strcmp(argv[i], "--jump") == 0)
+            ok = parse_int(value, 0, &opts->jump) && opts->jump < 63;
+        else if (ok && strcmp(argv[i], "--scale") == 0 && strcmp(value, "gpu") == 0)
+            opts->gpu_scale = 1;
+        else if (ok && strcmp(argv[i], "--scale") == 0 && strcmp(value, "cpu") == 0)
+            opts->gpu_scale = 0;
+        else if (ok && strcmp(argv[i], "--gens") == 0)
+            ok = parse_count(value, 0, &opts->gens);
+        else if (ok && strcmp(argv[i], "--seed") == 0)
+            ok = parse_count(value, 0, (long long*)&opts->seed);
+        else if (ok && strcmp(argv[i], "--in") == 0)
+            opts->in = value;
+        else if (ok && strcmp(argv[i], "--offset") == 0)
+            ok = parse_point(value, &opts->offset_x, &opts->offset_y);
+        else if (ok && strcmp(argv[i], "--out") == 0)
+            opts->out = value;
+        else if (ok && strcmp(argv[i], "--checkpoint-every") == 0)
+            ok = parse_count(value, 0, &opts->checkpoint_every);
+        else if (ok && strcmp(argv[i], "--stats") == 0)
+            opts->stats = value;
+        else if (ok && strcmp(argv[i], "--stats-every") == 0)
+            ok = parse_count(value, 1, &opts->stats_every);
+        else if (ok && strcmp(argv[i], "--ranks") == 0)
+            ok = parse_int(value, 1, &opts->ranks);
+        else if (ok && strcmp(argv[i], "--halo") == 0)
+            ok = parse_int(value, 1, &opts->halo);
+        else if (ok && strcmp(argv[i], "--ensemble") == 0)
+            ok = opts->ensemble = parse_range(value, &opts->first_seed, &opts->last_seed);
+        else if (ok && strcmp(argv[i], "--density") == 0)
+            ok = parse_percent(value, &opts->density);
+        else if (ok && strcmp(argv[i], "--jobs") == 0)
+            ok = parse_int(value, 0, &opts->jobs);
+        else
+            ok = 0;
+
+        if (!ok)
+        {
+            print_usage(argv[0]);
+            return 0;
+        }
+
+        i++;
+    }
+
+    return 1;
+}
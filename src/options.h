@@ -0,0 +1,126 @@
+/* options.h - Command line options
+ *
+ * Everything that can be changed from the command line ends up in here, so
+ * main() only has to look at one struct.
+*/
+
+#ifndef OPTIONS_H
+#define OPTIONS_H
+
+#include "rule.h"
+
+// 144p
+#define DEFAULT_GRID_WIDTH 256
+#define DEFAULT_GRID_HEIGHT 144
+
+// How big each cell is in pixels, which makes the window 720p by default
+#define DEFAULT_PIXEL_SIZE 5
+
+// Biggest window that gets opened without asking for it with --window.
+// Grids bigger than this get zoomed out to fit.
+#define DEFAULT_MAX_WINDOW_WIDTH 1920
+#define DEFAULT_MAX_WINDOW_HEIGHT 1080
+
+// Generations kept around to step back through, and the most memory they
+// can take up in MB, which makes for fewer of them on big grids
+#define DEFAULT_HISTORY 256
+#define DEFAULT_HISTORY_MEMORY 512
+
+typedef struct
+{
+    // Which engine to run the simulation with
+    const char* engine;
+
+    // Grid size in cells
+    int width;
+    int height;
+
+    // How big each cell is on screen to start with, the window is the grid
+    // size times this unless that's bigger than the default maximum
+    int pixel_size;
+
+    // Window size in pixels, 0 to size it to the grid
+    int window_width;
+    int window_height;
+
+    // How many threads to step with, 0 uses every CPU core
+    int threads;
+
+    // Every step in the window moves 2^jump generations ahead
+    int jump;
+
+    // Draw one texel per cell and let the GPU scale it up to the window,
+    // instead of filling in every pixel of every cell on the CPU
+    int gpu_scale;
+
+    // Wait for VSync when drawing, the simulation speed doesn't depend on it
+    int vsync;
+
+    // Step on a thread of its own while the window draws, see pipeline.h
+    int pipeline;
+
+    // Wrap around at the edges of the grid instead of them being dead
+    int wrap;
+
+    // Which Life-like rule to run, see rule.h
+    rule rule;
+
+    // Generations to remember for stepping backwards, 0 for none, and how
+    // many MB they can use
+    int history;
+    int history_memory;
+
+    // .gol, .rle or .cells file to start from, or NULL to start empty
+    const char* in;
+
+    // Where the top left corner of an .rle or .cells pattern goes,
+    // PATTERN_CENTER to put it in the middle
+    int offset_x;
+    int offset_y;
+
+    // Run without a window, just step gens generations as fast as possible
+    // and save the result to out (if it isn't NULL)
+    int headless;
+    long long gens;
+    const char* out;
+
+    // Save a copy every this many generations in headless mode, 0 for never
+    long long checkpoint_every;
+
+    // Look for the grid repeating itself in headless mode, and stop once it
+    // does if stop_on_cycle is set
+    int detect_cycles;
+    int stop_on_cycle;
+
+    // Write a line of timings to this CSV file every stats_every
+    // generations in headless mode, NULL for none
+    const char* stats;
+    long long stats_every;
+
+    // Split a headless run across this many ranks, which are threads unless
+    // mpi is set, in which case they're whatever mpirun started (see
+    // distrib.h). The ranks trade the halo cells their neighbours need every
+    // halo generations.
+    int ranks;
+    int mpi;
+    int halo;
+
+    // Run a random soup for every seed from first_seed to last_seed
+    // instead, jobs of them at a time (0 for one per core), with density of
+    // the cells alive, until they settle or hit gens (see ensemble.h)
+    int ensemble;
+    long long first_seed;
+    long long last_seed;
+    double density;
+    int jobs;
+
+    // Run the benchmarks instead, with soups made from seed
+    int bench;
+    unsigned long long seed;
+} options;
+
+// Fill opts from the command line. Prints the usage and returns 0 if the
+// arguments don't make sense, returns 1 otherwise.
+int options_parse(options* opts, int argc, char** argv);
+
+#endif
@@ -0,0 +1,210 @@
+/* overlay.c - Frame timing overlay
+*/
+
+#include <stdio.h>
+#include "overlay.h"
+
+// Screen pixels per font pixel
+#define FONT_SCALE 2
+
+// Every glyph is 3x5 font pixels, one octal digit per row with the top
+// bit on the left. Lowercase letters are drawn as uppercase.
+#define GLYPH_WIDTH 3
+#define GLYPH_HEIGHT 5
+
+static const uint8_t font[128][GLYPH_HEIGHT] =
+{
+    ['0'] = { 07, 05, 05, 05, 07 },
+    ['1'] = { 02, 06, 02, 02, 07 },
+    ['2'] = { 07, 01, 07, 04, 07 },
+    ['3'] = { 07, 01, 07, 01, 07 },
+    ['4'] = { 05, 05, 07, 01, 01 },
+    ['5'] = { 07, 04, 07, 01, 07 },
+    ['6'] = { 07, 04, 07, 05, 07 },
+    ['7'] = { 07, 01, 01, 02, 02 },
+    ['8'] = { 07, 05, 07, 05, 07 },
+    ['9'] = { 07, 05, 07, 01, 07 },
+    ['A'] = { 02, 05, 07, 05, 05 },
+    ['B'] = { 06, 05, 06, 05, 06 },
+    ['C'] = { 03, 04, 04, 04, 03 },
+    ['D'] = { 06, 05, 05, 05, 06 },
+    ['E'] = { 07, 04, 06, 04, 07 },
+    ['F'] = { 07, 04, 06, 04, 04 },
+    ['G'] = { 03, 04, 05, 05, 03 },
+    ['H'] = { 05, 05, 07, 05, 05 },
+    ['I'] = { 07, 02, 02, 02, 07 },
+    ['J'] = { 01, 01, 01, 05, 02 },
+    ['K'] = { 05, 05, 06, 05, 05 },
+    ['L'] = { 04, 04, 04, 04, 07 },
+    ['M'] = { 05, 07, 07, 05, 05 },
+    ['N'] = { 06, 05, 05, 05, 05 },
+    ['O'] = { 02, 05, 05, 05, 02 },
+    ['P'] = { 06, 05, 06, 04, 04 },
+    ['Q'] = { 02, 05, 05, 06, 03 },
+    ['R'] = { 06, 05, 06, 05, 05 },
+    ['S'] = { 03, 04, 02, 01, 06 },
+    ['T'] = { 07, 02, 02, 02, 02 },
+    ['U'] = { 05, 05, 05, 05, 07 },
+    ['V'] = { 05, 05, 05, 05, 02 },
+    ['W'] = { 05, 05, 07, 07, 05 },
+    ['X'] = { 05, 05, 02, 05, 05 },
+    ['Y'] = { 05, 05, 02, 02, 02 },
+    ['Z'] = { 07, 01, 02, 04, 07 },
+    ['.'] = { 00, 00, 00, 00, 02 },
+    [':'] = { 00, 02, 00, 02, 00 },
+    ['/'] = { 01, 01, 02, 04, 04 },
+    ['-'] = { 00, 00, 07, 00, 00 },
+};
+
+#define LINE_CHARS 28
+#define LINES (OVERLAY_PHASES + 6)
+
+static const char* phase_names[OVERLAY_PHASES] = { "events", "step", "paint", "upload", "present" };
+
+void overlay_init(overlay* o, uint64_t generation)
+{
+    o->visible = 0;
+    o->frames = 0;
+    o->generation = generation;
+    o->fps = 0;
+    o->gens_per_second = 0;
+    o->census_valid = 0;
+    o->alive_known = 0;
+    o->changes_known = 0;
+
+    for (int i = 0; i < OVERLAY_PHASES; i++)
+    {
+        o->ms[i] = 0;
+    }
+
+    stats_start(&o->timer);
+}
+
+void overlay_lap(overlay* o, int phase)
+{
+    stats_lap(&o->timer, phase);
+}
+
+void overlay_frame(overlay* o, uint64_t generation, const census* counted, int changes)
+{
+    o->frames++;
+
+    double seconds = stats_seconds(&o->timer);
+
+    if (seconds < OVERLAY_INTERVAL)
+        return;
+
+    o->fps = o->frames / seconds;
+
+    // Stepping back through the history or clearing the grid makes the
+    // generation go down, that's not negative speed
+    o->gens_per_second = generation > o->generation ? (generation - o->generation) / seconds : 0;
+
+    // Births and deaths per generation need a census at both ends
+    o->alive_known = counted != NULL;
+    o->changes_known = counted && changes && o->census_valid && o->changes && generation > o->generation;
+
+    if (counted)
+        o->alive = counted->population;
+
+    if (o->changes_known)
+    {
+        o->births = (double)(counted->births - o->counted.births) / (generation - o->generation);
+        o->deaths = (double)(counted->deaths - o->counted.deaths) / (generation - o->generation);
+    }
+
+    o->census_valid = counted != NULL;
+    o->changes = changes;
+
+    if (counted)
+        o->counted = *counted;
+
+    for (int i = 0; i < OVERLAY_PHASES; i++)
+    {
+        o->ms[i] = stats_ms(&o->timer, i) / o->frames;
+    }
+
+    o->frames = 0;
+    o->generation = generation;
+    stats_start(&o->timer);
+}
+
+// Add the rectangles for every font pixel in text, returns how many
+static int text_rects(const char* text, int left, int top, SDL_Rect* rects)
+{
+    int count = 0;
+
+    for (int i = 0; text[i]; i++)
+    {
+        int c = (unsigned char)text[i];
+
+        if (c >= 'a' && c <= 'z')
+            c -= 'a' - 'A';
+        if (c >= 128)
+            continue;
+
+        for (int y = 0; y < GLYPH_HEIGHT; y++)
+        {
+            for (int x = 0; x < GLYPH_WIDTH; x++)
+            {
+                if (!(font[c][y] & (4 >> x)))
+                    continue;
+
+                SDL_Rect* rect = &rects[count++];
+                rect->x = left + ((GLYPH_WIDTH + 1) * i + x) * FONT_SCALE;
+                rect->y = top + y * FONT_SCALE;
+                rect->w = FONT_SCALE;
+                rect->h = FONT_SCALE;
+            }
+        }
+    }
+
+    return count;
+}
+
+void overlay_draw(const overlay* o, SDL_Renderer* renderer, uint64_t in_view)
+{
+    if (!o->visible)
+        return;
+
+    char lines[LINES][LINE_CHARS + 1];
+    int count = 0;
+
+    snprintf(lines[count++], sizeof(lines[0]), "fps %.1f", o->fps);
+    snprintf(lines[count++], sizeof(lines[0]), "gens/s %.0f", o->gens_per_second);
+
+    for (int i = 0; i < OVERLAY_PHASES; i++)
+    {
+        snprintf(lines[count++], sizeof(lines[0]), "%-8s%6.2f ms", phase_names[i], o->ms[i]);
+    }
+
+    if (o->alive_known)
+        snprintf(lines[count++], sizeof(lines[0]), "alive %llu", (unsigned long long)o->alive);
+
+    if (in_view != UINT64_MAX)
+        snprintf(lines[count++], sizeof(lines[0]), "in view %llu", (unsigned long long)in_view);
+
+    if (o->changes_known)
+    {
+        snprintf(lines[count++], sizeof(lines[0]), "born %.1f/gen", o->births);
+        snprintf(lines[count++], sizeof(lines[0]), "died %.1f/gen", o->deaths);
+    }
+
+    // Every font pixel that could be lit, if every line was full of 8s
+    static SDL_Rect rects[LINES * LINE_CHARS * GLYPH_WIDTH * GLYPH_HEIGHT];
+    int total = 0;
+    int line_height = (GLYPH_HEIGHT + 1) * FONT_SCALE;
+
+    for (int i = 0; i < count; i++)
+    {
+        total += text_rects(lines[i], FONT_SCALE * 2, FONT_SCALE * 2 + line_height * i, &rects[total]);
+    }
+
+    // Black box behind it so it can be read over live cells
+    SDL_Rect box = { 0, 0, ((GLYPH_WIDTH + 1) * LINE_CHARS + 3) * FONT_SCALE, line_height * count + FONT_SCALE * 3 };
+
+    SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
+    SDL_RenderFillRect(renderer, &box);
+    SDL_SetRenderDrawColor(renderer, 0, 255, 0, 255);
+    SDL_RenderFillRects(renderer, rects, total);
+}
@@ -0,0 +1,82 @@
+/* overlay.h - Frame timing overlay
+ *
+ * Shows where each frame's time goes in the top left corner of the window:
+ * handling events and drawing cells by hand, stepping the simulation,
+ * painting changed cells into the screen buffer, uploading it to the
+ * texture and presenting it. Along with the frame rate, generations per
+ * second, how many cells are alive (in all and in view) and how many get
+ * born and die every generation.
+ *
+ * The numbers are averaged over OVERLAY_INTERVAL seconds of frames so
+ * they're stable enough to read. The text is drawn with a tiny built in
+ * font, one filled rectangle per font pixel, so it doesn't need a font
+ * library.
+*/
+
+#ifndef OVERLAY_H
+#define OVERLAY_H
+
+#include <SDL2/SDL.h>
+#include <stdint.h>
+#include "stats.h"
+#include "engine.h"
+
+#define OVERLAY_INTERVAL 0.5
+
+// Parts of a frame, in the order they happen
+enum
+{
+    OVERLAY_EVENTS,
+    OVERLAY_STEP,
+    OVERLAY_PAINT,
+    OVERLAY_UPLOAD,
+    OVERLAY_PRESENT,
+    OVERLAY_PHASES
+};
+
+typedef struct
+{
+    // Drawn or not, the timing happens either way
+    int visible;
+
+    // Laps for every frame since the numbers shown were last updated
+    stats timer;
+    int frames;
+    uint64_t generation;
+
+    // The census at the same time, if there was one, and whether it counted
+    // births and deaths
+    census counted;
+    int census_valid;
+    int changes;
+
+    // What's on screen
+    double fps;
+    double gens_per_second;
+    double ms[OVERLAY_PHASES];
+
+    // Only if the census is known, see changes_known for births and deaths
+    int alive_known;
+    uint64_t alive;
+    int changes_known;
+    double births;
+    double deaths;
+} overlay;
+
+// Start timing from now, with the simulation at generation
+void overlay_init(overlay* o, uint64_t generation);
+
+// Mark the end of a phase of the current frame
+void overlay_lap(overlay* o, int phase);
+
+// Call once at the end of every frame with the generation that was drawn,
+// updates the numbers shown once OVERLAY_INTERVAL has gone by. The census of
+// that generation can be NULL if nobody took one, changes is what
+// engine_census() returned for it.
+void overlay_frame(overlay* o, uint64_t generation, const census* counted, int changes);
+
+// Draw it over whatever is on the renderer, if it's visible, with in_view
+// cells alive on screen (UINT64_MAX if nobody counted them)
+void overlay_draw(const overlay* o, SDL_Renderer* renderer, uint64_t in_view);
+
+#endif
@@ -0,0 +1,257 @@
+/* pattern.c - Importing standard pattern files
+*/
+
+#include <SDL2/SDL.h>
+#include <ctype.h>
+#include <stdio.h>
+#include <string.h>
+#include "pattern.h"
+#include "savefile.h"
+
+// Longest RLE header line that gets looked at, the rest is skipped
+#define HEADER_LINE 256
+
+// Bring count cells to life starting at (x, y), going right
+static void put_run(engine* e, long long x, long long y, long long count)
+{
+    if (y < 0 || y >= e->height)
+        return;
+
+    long long start = x > 0 ? x : 0;
+    long long end = x + count < e->width ? x + count : e->width;
+
+    for (long long i = start; i < end; i++)
+    {
+        e->set_cell(e, (int)i, (int)y, 1);
+    }
+}
+
+// Where the pattern starts so it ends up in the middle, or at offset
+static int place(int offset, int grid, long long size)
+{
+    if (offset != PATTERN_CENTER)
+        return offset;
+
+    return (int)((grid - size) / 2);
+}
+
+static void skip_line(FILE* fp)
+{
+    int c;
+
+    while ((c = fgetc(fp)) != EOF && c != '\n')
+        ;
+}
+
+// The rule is only checked, the pattern runs with whatever rule the engine
+// has. It's up to --rule to pick the right one.
+static void check_rule(const char* line, const engine* e)
+{
+    const char* found = strstr(line, "rule");
+    if (!found)
+        return;
+
+    found += 4;
+    while (*found == ' ' || *found == '\t' || *found == '=')
+        found++;
+
+    char text[32];
+    snprintf(text, sizeof(text), "%.*s", (int)strcspn(found, ", \t\r\n"), found);
+
+    rule wanted;
+
+    if (rule_parse(text, &wanted) && rule_equal(&wanted, &e->rule))
+        return;
+
+    char running[32];
+    rule_format(&e->rule, running, sizeof(running));
+
+    printf("Pattern is for rule %s, running it as %s anyway\n", text, running);
+}
+
+int pattern_load_rle(const char* path, engine* e, int x, int y)
+{
+    FILE* fp = fopen(path, "r");
+    if (!fp)
+        return 0;
+
+    int width = 0;
+    int height = 0;
+    int c;
+
+    // Comments and the header come first, the first other line is the
+    // start of the cells
+    while ((c = fgetc(fp)) != EOF)
+    {
+        if (c == '#')
+        {
+            skip_line(fp);
+        }
+        else if (c == 'x')
+        {
+            char line[HEADER_LINE] = "x";
+
+            if (fgets(&line[1], sizeof(line) - 1, fp) && !strchr(line, '\n'))
+                skip_line(fp);
+
+            if (sscanf(line, "x = %d , y = %d", &width, &height) != 2 || width < 0 || height < 0)
+            {
+                fclose(fp);
+                return 0;
+            }
+
+            check_rule(line, e);
+        }
+        else if (!isspace(c))
+        {
+            ungetc(c, fp);
+            break;
+        }
+    }
+
+    e->clear(e);
+    e->generation = 0;
+
+    long long left = place(x, e->width, width);
+    long long cx = left;
+    long long cy = place(y, e->height, height);
+    long long count = 0;
+    int ok = 0;
+
+    while ((c = fgetc(fp)) != EOF)
+    {
+        if (isdigit(c))
+        {
+            // Anything this big is way past the edge of any grid anyway
+            if (count < 1LL << 40)
+                count = count * 10 + (c - '0');
+            continue;
+        }
+
+        long long run = count > 0 ? count : 1;
+        count = 0;
+
+        if (c == '!')
+        {
+            ok = 1;
+            break;
+        }
+        else if (c == '$')
+        {
+            cx = left;
+            cy += run;
+        }
+        else if (c == 'b' || c == '.')
+        {
+            cx += run;
+        }
+        else if (isalpha(c))
+        {
+            // "o" is alive, and any other letter is one of the states of a
+            // rule with more than two, which all count as alive here
+            put_run(e, cx, cy, run);
+            cx += run;
+        }
+        else if (!isspace(c))
+        {
+            break;
+        }
+    }
+
+    fclose(fp);
+    return ok;
+}
+
+int pattern_load_cells(const char* path, engine* e, int x, int y)
+{
+    FILE* fp = fopen(path, "r");
+    if (!fp)
+        return 0;
+
+    // There's no header, so it takes a first pass to know how big it is
+    // when it has to be centered
+    long long width = 0;
+    long long height = 0;
+    int c;
+
+    if (x == PATTERN_CENTER || y == PATTERN_CENTER)
+    {
+        long long length = 0;
+
+        while ((c = fgetc(fp)) != EOF)
+        {
+            if (c == '!' && length == 0)
+            {
+                skip_line(fp);
+            }
+            else if (c == '\n')
+            {
+                width = length > width ? length : width;
+                height++;
+                length = 0;
+            }
+            else if (c != '\r')
+            {
+                length++;
+            }
+        }
+
+        if (length > 0)
+        {
+            width = length > width ? length : width;
+            height++;
+        }
+
+        rewind(fp);
+    }
+
+    e->clear(e);
+    e->generation = 0;
+
+    long long left = place(x, e->width, width);
+    long long cx = left;
+    long long cy = place(y, e->height, height);
+
+    while ((c = fgetc(fp)) != EOF)
+    {
+        if (c == '!' && cx == left)
+        {
+            skip_line(fp);
+        }
+        else if (c == '\n')
+        {
+            cx = left;
+            cy++;
+        }
+        else if (c == 'O' || c == 'o' || c == '*')
+        {
+            put_run(e, cx, cy, 1);
+            cx++;
+        }
+        else if (c != '\r')
+        {
+            cx++;
+        }
+    }
+
+    fclose(fp);
+    return 1;
+}
+
+static int has_extension(const char* path, const char* ext)
+{
+    size_t length = strlen(path);
+    size_t ext_length = strlen(ext);
+
+    return length >= ext_length && SDL_strcasecmp(&path[length - ext_length], ext) == 0;
+}
+
+int pattern_load(const char* path, engine* e, int x, int y)
+{
+    if (has_extension(path, ".rle"))
+        return pattern_load_rle(path, e, x, y);
+    if (has_extension(path, ".cells"))
+        return pattern_load_cells(path, e, x, y);
+
+    return savefile_load(path, e);
+}
@@ -0,0 +1,35 @@
+/* pattern.h - Importing standard pattern files
+ *
+ * Reads the two formats most other Life programs and the LifeWiki use:
+ *
+ *  - .rle: a header like "x = 3, y = 3, rule = B3/S23", followed by the
+ *    rows as runs, "b" for dead, "o" for alive, "$" for the end of a row and
+ *    "!" at the end. "3o$" is three live cells and then the next row.
+ *  - .cells: plain text, one line per row, "." for dead and "O" for alive.
+ *    Lines starting with "!" are comments.
+ *
+ * Both are read a character at a time, so the whole file is never in memory
+ * at once. Anything that falls outside the grid is cut off.
+*/
+
+#ifndef PATTERN_H
+#define PATTERN_H
+
+#include <limits.h>
+#include "engine.h"
+
+// Pass as x and/or y to put the middle of the pattern in the middle of the
+// grid
+#define PATTERN_CENTER INT_MIN
+
+// Clear the grid and put the pattern in it with its top left corner at
+// (x, y). Returns 1 on success, 0 if the file couldn't be opened or isn't a
+// valid pattern.
+int pattern_load_rle(const char* path, engine* e, int x, int y);
+int pattern_load_cells(const char* path, engine* e, int x, int y);
+
+// Load any file the program understands, .rle and .cells go through the
+// functions above and everything else is treated as a .gol file
+int pattern_load(const char* path, engine* e, int x, int y);
+
+#endif
@@ -0,0 +1,261 @@
+/* pipeline.c - Stepping on its own thread while the window draws
+*/
+
+#include <SDL2/SDL.h>
+#include <stdlib.h>
+#include "pipeline.h"
+
+// Set on the buffer in between while it hasn't been picked up yet
+#define PIPELINE_FRESH 4
+
+struct pipeline
+{
+    engine* sim;
+    strokes* paint;
+    double budget;
+
+    SDL_Thread* thread;
+    SDL_mutex* lock;
+
+    // Signalled when there is anything new for the thread: starting,
+    // stopping, a new view, speed or stroke, or time to quit
+    SDL_cond* wake;
+
+    // Signalled when it stops stepping
+    SDL_cond* idle;
+
+    // Everything from here to speed is only touched while holding lock
+    int running;
+    int stepping;
+    int quit;
+
+    render_frame view;
+    int view_changed;
+    int poked;
+    int rate;
+
+    // Only touched by the thread while stepping
+    scheduler speed;
+
+    // The three buffers. writing is only used by the thread, reading only
+    // by whoever calls pipeline_latest(), and ready is the index of the one
+    // in between, with PIPELINE_FRESH set if it's newer than reading.
+    render_frame frames[3];
+    int writing;
+    int reading;
+    SDL_atomic_t ready;
+};
+
+// Count the view into the buffer being written, and swap it into the
+// middle for pipeline_latest() to pick up
+static void publish(pipeline* p, const render_frame* view)
+{
+    render_frame* f = &p->frames[p->writing];
+    uint32_t* counts = f->counts;
+
+    *f = *view;
+    f->counts = counts;
+    render_count(f, p->sim);
+
+    // SDL_AtomicSet() alone doesn't keep the counts from showing up after
+    // the swap on every CPU, or the reads of the buffer we get back from
+    // still coming in after it
+    SDL_MemoryBarrierRelease();
+    p->writing = SDL_AtomicSet(&p->ready, p->writing | PIPELINE_FRESH) & ~PIPELINE_FRESH;
+    SDL_MemoryBarrierAcquire();
+}
+
+static int pipeline_main(void* data)
+{
+    pipeline* p = data;
+
+    SDL_LockMutex(p->lock);
+
+    while (!p->quit)
+    {
+        if (!p->running)
+        {
+            // Let pipeline_stop() know the engine can be touched again
+            p->stepping = 0;
+            SDL_CondBroadcast(p->idle);
+            SDL_CondWait(p->wake, p->lock);
+            continue;
+        }
+
+        p->stepping = 1;
+        p->speed.rate = p->rate;
+
+        render_frame view = p->view;
+        int recount = p->view_changed;
+        p->view_changed = 0;
+        p->poked = 0;
+
+        SDL_UnlockMutex(p->lock);
+
+        // Between batches is between generations, and nothing else is
+        // touching the engine
+        int drawn = strokes_apply(p->paint, p->sim);
+        int stepped = scheduler_run(&p->speed, p->sim, p->budget);
+
+        if (stepped > 0 || recount || drawn > 0)
+            publish(p, &view);
+
+        SDL_LockMutex(p->lock);
+
+        // Nothing was due, so sleep until something is. Anything that
+        // changes what to do wakes it up early.
+        if (stepped == 0 && p->running && !p->view_changed && !p->poked && !p->quit)
+        {
+            Uint32 ms = (Uint32)(scheduler_wait(&p->speed) * 1000) + 1;
+            SDL_CondWaitTimeout(p->wake, p->lock, ms);
+        }
+    }
+
+    p->stepping = 0;
+    SDL_CondBroadcast(p->idle);
+    SDL_UnlockMutex(p->lock);
+
+    return 0;
+}
+
+pipeline* pipeline_create(engine* sim, strokes* paint, size_t texels, double budget)
+{
+    pipeline* p = calloc(1, sizeof(pipeline));
+    if (!p)
+        return NULL;
+
+    p->sim = sim;
+    p->paint = paint;
+    p->budget = budget;
+    p->writing = 0;
+    p->reading = 2;
+    SDL_AtomicSet(&p->ready, 1);
+
+    int ok = 1;
+
+    for (int i = 0; i < 3; i++)
+    {
+        p->frames[i].counts = malloc(texels * sizeof(uint32_t));
+        ok = ok && p->frames[i].counts;
+    }
+
+    p->lock = SDL_CreateMutex();
+    p->wake = SDL_CreateCond();
+    p->idle = SDL_CreateCond();
+
+    if (ok && p->lock && p->wake && p->idle)
+        p->thread = SDL_CreateThread(pipeline_main, "gol simulation", p);
+
+    if (!p->thread)
+    {
+        pipeline_destroy(p);
+        return NULL;
+    }
+
+    return p;
+}
+
+void pipeline_destroy(pipeline* p)
+{
+    if (!p)
+        return;
+
+    if (p->thread)
+    {
+        SDL_LockMutex(p->lock);
+        p->quit = 1;
+        SDL_CondSignal(p->wake);
+        SDL_UnlockMutex(p->lock);
+
+        SDL_WaitThread(p->thread, NULL);
+    }
+
+    if (p->idle)
+        SDL_DestroyCond(p->idle);
+    if (p->wake)
+        SDL_DestroyCond(p->wake);
+    if (p->lock)
+        SDL_DestroyMutex(p->lock);
+
+    for (int i = 0; i < 3; i++)
+    {
+        free(p->frames[i].counts);
+    }
+
+    free(p);
+}
+
+void pipeline_start(pipeline* p, const scheduler* s)
+{
+    SDL_LockMutex(p->lock);
+
+    p->speed = *s;
+    p->rate = s->rate;
+    scheduler_reset(&p->speed);
+
+    // Anything counted before it was stopped is out of date now, since the
+    // grid could have been changed by hand since then
+    SDL_AtomicSet(&p->ready, SDL_AtomicGet(&p->ready) & ~PIPELINE_FRESH);
+
+    p->running = 1;
+    p->view_changed = 1;
+    SDL_CondSignal(p->wake);
+    SDL_UnlockMutex(p->lock);
+}
+
+void pipeline_stop(pipeline* p)
+{
+    SDL_LockMutex(p->lock);
+    p->running = 0;
+    SDL_CondSignal(p->wake);
+
+    while (p->stepping)
+        SDL_CondWait(p->idle, p->lock);
+
+    SDL_UnlockMutex(p->lock);
+}
+
+void pipeline_set_rate(pipeline* p, int rate)
+{
+    SDL_LockMutex(p->lock);
+    p->rate = rate;
+    SDL_CondSignal(p->wake);
+    SDL_UnlockMutex(p->lock);
+}
+
+void pipeline_set_view(pipeline* p, const render_frame* view)
+{
+    SDL_LockMutex(p->lock);
+
+    if (view->shift != p->view.shift || view->bx != p->view.bx || view->by != p->view.by
+        || view->columns != p->view.columns || view->rows != p->view.rows)
+    {
+        p->view = *view;
+        p->view.counts = NULL;
+        p->view_changed = 1;
+        SDL_CondSignal(p->wake);
+    }
+
+    SDL_UnlockMutex(p->lock);
+}
+
+void pipeline_poke(pipeline* p)
+{
+    SDL_LockMutex(p->lock);
+    p->poked = 1;
+    SDL_CondSignal(p->wake);
+    SDL_UnlockMutex(p->lock);
+}
+
+const render_frame* pipeline_latest(pipeline* p)
+{
+    if (!(SDL_AtomicGet(&p->ready) & PIPELINE_FRESH))
+        return NULL;
+
+    // The same barriers as in publish(), the other way around
+    SDL_MemoryBarrierRelease();
+    p->reading = SDL_AtomicSet(&p->ready, p->reading) & ~PIPELINE_FRESH;
+    SDL_MemoryBarrierAcquire();
+
+    return &p->frames[p->reading];
+}
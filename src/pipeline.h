@@ -0,0 +1,68 @@
+/* pipeline.h - Stepping on its own thread while the window draws
+ *
+ * Normally every frame handles events, steps the simulation, draws it and
+ * waits for VSync, all on the main thread one after the other, so a slow
+ * step makes for a slow frame and waiting for VSync is time not spent
+ * stepping. With --pipeline the simulation gets a thread of its own while
+ * it's running. After every batch of generations it counts the texels of
+ * the view (see render_count()) and hands them over, and the main thread
+ * just draws whatever the newest counts are.
+ *
+ * The counts go through three buffers: one the simulation thread is
+ * filling, one the main thread is drawing, and the newest finished one in
+ * between. Handing one over is swapping it with the one in between, so
+ * neither side ever waits for the other and frames that were never drawn
+ * just get written over.
+ *
+ * Cells drawn with the mouse while it's running get drawn into the engine
+ * by the thread, before every batch (see strokes.h).
+ *
+ * While the simulation is paused the main thread has the engine to itself
+ * again, for drawing cells, loading, stepping through the history and so on.
+*/
+
+#ifndef PIPELINE_H
+#define PIPELINE_H
+
+#include "engine.h"
+#include "scheduler.h"
+#include "render.h"
+#include "strokes.h"
+
+typedef struct pipeline pipeline;
+
+// Start the simulation thread, which steps sim in batches of up to budget
+// seconds, draws whatever is in paint into it in between and has room for
+// views of up to texels texels. Returns NULL if the thread or buffers
+// couldn't be made.
+pipeline* pipeline_create(engine* sim, strokes* paint, size_t texels, double budget);
+
+// Stop stepping if it still is, and stop the thread
+void pipeline_destroy(pipeline* p);
+
+// Hand the engine over to the simulation thread and start stepping at the
+// speed (and with the history) of s. The engine can't be touched until
+// pipeline_stop().
+void pipeline_start(pipeline* p, const scheduler* s);
+
+// Stop stepping, returns once the batch being stepped is done and the
+// engine is the caller's again
+void pipeline_stop(pipeline* p);
+
+// Change the speed while it's running
+void pipeline_set_rate(pipeline* p, int rate);
+
+// Which texels to count from now on, everything in view but the counts.
+// Moving the view gets it counted again right away, even when no
+// generation is due.
+void pipeline_set_view(pipeline* p, const render_frame* view);
+
+// Something new went into the strokes, so get it drawn and counted right
+// away, even when no generation is due
+void pipeline_poke(pipeline* p);
+
+// The newest counts, or NULL if there's nothing new since the last call.
+// They stay the same until the next call.
+const render_frame* pipeline_latest(pipeline* p);
+
+#endif
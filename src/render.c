@@ -0,0 +1,421 @@
+/* render.c - Drawing the grid
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include "render.h"
+#include "aligned.h"
+#include "gpuview.h"
+
+// Past this much of the view changing, upload the whole buffer at once
+#define RENDER_FULL_FRACTION 0.5
+
+// Keeps the view where coordinates still fit in an int
+#define RENDER_MAX_VIEW (1 << 30)
+
+// Round down to a multiple of 2^shift, negative numbers too
+static int64_t align_down(int64_t v, int shift)
+{
+    int64_t size = (int64_t)1 << shift;
+    return v - ((v % size) + size) % size;
+}
+
+// Cells across and down that fit in the window
+static int64_t view_across(const render* r)
+{
+    return (int64_t)(r->window_width / r->zoom) << r->shift;
+}
+
+static int64_t view_down(const render* r)
+{
+    return (int64_t)(r->window_height / r->zoom) << r->shift;
+}
+
+// Move the view's top left corner to cell (x, y). Unless there's something
+// to see past the edges, the middle of the window has to stay on the grid.
+static void set_view(render* r, int64_t x, int64_t y)
+{
+    int64_t min_x = -RENDER_MAX_VIEW, max_x = RENDER_MAX_VIEW;
+    int64_t min_y = -RENDER_MAX_VIEW, max_y = RENDER_MAX_VIEW;
+
+    if (!r->unbounded)
+    {
+        min_x = -view_across(r) / 2;
+        max_x = r->grid_width - view_across(r) / 2;
+        min_y = -view_down(r) / 2;
+        max_y = r->grid_height - view_down(r) / 2;
+    }
+
+    x = x < min_x ? min_x : x > max_x ? max_x : x;
+    y = y < min_y ? min_y : y > max_y ? max_y : y;
+
+    // Blocks always start at a multiple of their size, so the counts of
+    // blocks that didn't change stay the same from frame to frame
+    x = align_down(x, r->shift);
+    y = align_down(y, r->shift);
+
+    if (x != r->view_x || y != r->view_y)
+        r->full = 1;
+
+    r->view_x = (int)x;
+    r->view_y = (int)y;
+}
+
+// After the zoom changed
+static void update_zoom(render* r)
+{
+    r->columns = (r->window_width + r->zoom - 1) / r->zoom;
+    r->rows = (r->window_height + r->zoom - 1) / r->zoom;
+    r->cell_size = r->gpu_scale ? 1 : r->zoom;
+    r->pan_x = 0;
+    r->pan_y = 0;
+    r->full = 1;
+}
+
+int render_init(render* r, SDL_Renderer* renderer, const engine* sim, int window_width, int window_height, int pixel_size, int gpu_scale)
+{
+    memset(r, 0, sizeof(render));
+
+    r->renderer = renderer;
+    r->grid_width = sim->width;
+    r->grid_height = sim->height;
+    r->unbounded = sim->unbounded;
+    r->window_width = window_width;
+    r->window_height = window_height;
+    r->gpu_scale = gpu_scale;
+    r->width = window_width;
+    r->height = window_height;
+
+    // Cells should stay sharp squares when the texture gets scaled up.
+    // This has to be set before the texture is created.
+    SDL_SetHint(SDL_HINT_RENDER_SCALE_QUALITY, "0");
+
+    r->texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STREAMING, r->width, r->height);
+    r->pixels = aligned_calloc((size_t)r->width * r->height, sizeof(uint32_t));
+    r->shown = aligned_calloc((size_t)r->width * r->height, sizeof(uint32_t));
+    r->counts = malloc(sizeof(uint32_t) * r->width);
+    r->dirty = malloc(sizeof(SDL_Rect) * ((r->height + RENDER_BAND_ROWS - 1) / RENDER_BAND_ROWS));
+
+    if (!r->texture || !r->pixels || !r->shown || !r->counts || !r->dirty)
+    {
+        render_free(r);
+        return 0;
+    }
+
+    // Grids that are on the GPU get drawn from there if the renderer can
+    if (sim->texture)
+        r->gpu = gpuview_create(renderer);
+
+    // The whole grid at pixel_size if it fits, like before there was a view
+    if ((int64_t)r->grid_width * pixel_size <= window_width && (int64_t)r->grid_height * pixel_size <= window_height)
+    {
+        r->zoom = pixel_size;
+        update_zoom(r);
+        set_view(r, 0, 0);
+    }
+    else
+    {
+        render_fit(r);
+    }
+
+    return 1;
+}
+
+void render_free(render* r)
+{
+    gpuview_destroy(r->gpu);
+
+    if (r->texture)
+        SDL_DestroyTexture(r->texture);
+
+    aligned_free(r->pixels);
+    aligned_free(r->shown);
+    free(r->counts);
+    free(r->dirty);
+
+    memset(r, 0, sizeof(render));
+}
+
+void render_pan(render* r, int dx, int dy)
+{
+    r->pan_x += dx;
+    r->pan_y += dy;
+
+    // Only whole texels, the rest waits for the next move
+    int tx = r->pan_x / r->zoom;
+    int ty = r->pan_y / r->zoom;
+
+    r->pan_x -= tx * r->zoom;
+    r->pan_y -= ty * r->zoom;
+
+    set_view(r, r->view_x + (int64_t)tx * ((int64_t)1 << r->shift), r->view_y + (int64_t)ty * ((int64_t)1 << r->shift));
+}
+
+void render_zoom(render* r, int steps, int x, int y)
+{
+    // The cell under (x, y), which should still be there afterwards
+    int64_t cx = r->view_x + (int64_t)(x / r->zoom) * ((int64_t)1 << r->shift);
+    int64_t cy = r->view_y + (int64_t)(y / r->zoom) * ((int64_t)1 << r->shift);
+
+    for (; steps > 0; steps--)
+    {
+        if (r->shift > 0)
+            r->shift--;
+        else if (r->zoom * 2 <= RENDER_MAX_ZOOM)
+            r->zoom *= 2;
+    }
+
+    for (; steps < 0; steps++)
+    {
+        // Past seeing the whole grid there's nothing more to see
+        if (!r->unbounded && view_across(r) >= r->grid_width && view_down(r) >= r->grid_height)
+            break;
+
+        if (r->zoom > 1)
+            r->zoom /= 2;
+        else if (r->shift < RENDER_MAX_SHIFT)
+            r->shift++;
+    }
+
+    update_zoom(r);
+    set_view(r, cx - (int64_t)(x / r->zoom) * ((int64_t)1 << r->shift), cy - (int64_t)(y / r->zoom) * ((int64_t)1 << r->shift));
+}
+
+void render_fit(render* r)
+{
+    int fit_x = r->window_width / r->grid_width;
+    int fit_y = r->window_height / r->grid_height;
+    int fit = fit_x < fit_y ? fit_x : fit_y;
+
+    r->zoom = fit < 1 ? 1 : fit > RENDER_MAX_ZOOM ? RENDER_MAX_ZOOM : fit;
+    r->shift = 0;
+
+    while (r->shift < RENDER_MAX_SHIFT && (view_across(r) < r->grid_width || view_down(r) < r->grid_height))
+        r->shift++;
+
+    update_zoom(r);
+    set_view(r, (r->grid_width - view_across(r)) / 2, (r->grid_height - view_down(r)) / 2);
+}
+
+void render_cell_at(const render* r, int x, int y, int* cx, int* cy)
+{
+    *cx = (int)(r->view_x + (int64_t)(x / r->zoom) * ((int64_t)1 << r->shift));
+    *cy = (int)(r->view_y + (int64_t)(y / r->zoom) * ((int64_t)1 << r->shift));
+}
+
+// What a texel with count live cells in it looks like
+static uint32_t texel_color(const render* r, uint32_t count)
+{
+    if (count == 0)
+        return 0;
+
+    if (r->shift == 0)
+        return UINT32_MAX;
+
+    // Half full is already as bright as it gets, random soups hardly ever
+    // get past that
+    uint64_t area = (uint64_t)1 << (2 * r->shift);
+    uint64_t level = RENDER_DIM + (255 - RENDER_DIM) * 2 * (uint64_t)count / area;
+
+    if (level > 255)
+        level = 255;
+
+    return 0xFF000000u | (uint32_t)level * 0x010101u;
+}
+
+// Each texel is cell_size x cell_size pixels, cut off at the edge of the
+// texture
+static void paint_texel(render* r, int tx, int ty, uint32_t color)
+{
+    int x0 = tx * r->cell_size;
+    int y0 = ty * r->cell_size;
+    uint32_t* pixel = &r->pixels[(size_t)r->width * y0 + x0];
+
+    if (r->cell_size == 1)
+    {
+        *pixel = color;
+        return;
+    }
+
+    int w = r->width - x0 < r->cell_size ? r->width - x0 : r->cell_size;
+    int h = r->height - y0 < r->cell_size ? r->height - y0 : r->cell_size;
+
+    for (int y = 0; y < h; y++)
+    {
+        for (int x = 0; x < w; x++)
+        {
+            pixel[x] = color;
+        }
+
+        pixel += r->width;
+    }
+}
+
+void render_view(const render* r, render_frame* f)
+{
+    // The view always starts on a whole block
+    int64_t size = (int64_t)1 << r->shift;
+
+    f->shift = r->shift;
+    f->bx = (int)(r->view_x / size);
+    f->by = (int)(r->view_y / size);
+    f->columns = r->columns;
+    f->rows = r->rows;
+}
+
+void render_count(render_frame* f, engine* sim)
+{
+    for (int y = 0; y < f->rows; y++)
+    {
+        engine_count_blocks(sim, f->shift, f->bx, f->by + y, f->columns, &f->counts[(size_t)f->columns * y]);
+    }
+
+    f->generation = sim->generation;
+    f->changes = engine_census(sim, &f->counted);
+}
+
+// Paint the texels from f if it's there, or count them out of sim a row at
+// a time if it isn't
+static void paint(render* r, engine* sim, const render_frame* f)
+{
+    int rects = 0;
+    long long dirty_texels = 0;
+
+    render_frame view;
+    render_view(r, &view);
+
+    // Everything gets counted again from scratch
+    if (r->full)
+        r->population = 0;
+
+    for (int band = 0; band < r->rows; band += RENDER_BAND_ROWS)
+    {
+        int band_end = band + RENDER_BAND_ROWS < r->rows ? band + RENDER_BAND_ROWS : r->rows;
+
+        // First and last column that changed in this band
+        int min_x = r->columns;
+        int max_x = -1;
+
+        for (int y = band; y < band_end; y++)
+        {
+            uint32_t* shown = &r->shown[(size_t)r->width * y];
+            const uint32_t* counts = r->counts;
+
+            if (f)
+                counts = &f->counts[(size_t)f->columns * y];
+            else
+                engine_count_blocks(sim, view.shift, view.bx, view.by + y, view.columns, r->counts);
+
+            // Most rows don't change at all, so skip them quickly
+            if (!r->full && memcmp(counts, shown, r->columns * sizeof(uint32_t)) == 0)
+                continue;
+
+            for (int x = 0; x < r->columns; x++)
+            {
+                if (r->full || counts[x] != shown[x])
+                {
+                    if (!r->full)
+                        r->population -= shown[x];
+
+                    r->population += counts[x];
+                    shown[x] = counts[x];
+                    paint_texel(r, x, y, texel_color(r, shown[x]));
+
+                    if (x < min_x)
+                        min_x = x;
+                    if (x > max_x)
+                        max_x = x;
+                }
+            }
+        }
+
+        if (max_x >= 0)
+        {
+            SDL_Rect* rect = &r->dirty[rects++];
+            rect->x = min_x * r->cell_size;
+            rect->y = band * r->cell_size;
+            rect->w = (max_x - min_x + 1) * r->cell_size;
+            rect->h = (band_end - band) * r->cell_size;
+
+            if (rect->x + rect->w > r->width)
+                rect->w = r->width - rect->x;
+            if (rect->y + rect->h > r->height)
+                rect->h = r->height - rect->y;
+
+            dirty_texels += (long long)(max_x - min_x + 1) * (band_end - band);
+        }
+    }
+
+    r->rects = rects;
+    r->upload_all = r->full || dirty_texels > RENDER_FULL_FRACTION * r->columns * r->rows;
+    r->full = 0;
+}
+
+void render_paint(render* r, engine* sim)
+{
+    // Nothing to count, it all gets drawn from the engine's texture
+    if (r->gpu)
+    {
+        r->gpu_texture = sim->texture(sim);
+        r->population = UINT64_MAX;
+        return;
+    }
+
+    paint(r, sim, NULL);
+}
+
+int render_paint_frame(render* r, const render_frame* f)
+{
+    render_frame view;
+    render_view(r, &view);
+
+    if (f->shift != view.shift || f->bx != view.bx || f->by != view.by || f->columns != view.columns || f->rows != view.rows)
+        return 0;
+
+    paint(r, NULL, f);
+    return 1;
+}
+
+void render_upload(render* r)
+{
+    if (r->gpu_texture)
+    {
+        gpuview_draw(r->gpu, r, r->gpu_texture);
+        return;
+    }
+
+    // The part of the texture the view is in
+    SDL_Rect used = { 0, 0, r->columns * r->cell_size, r->rows * r->cell_size };
+
+    if (used.w > r->width)
+        used.w = r->width;
+    if (used.h > r->height)
+        used.h = r->height;
+
+    // Copy the changed parts of the screen buffer to the texture
+    if (r->upload_all)
+    {
+        SDL_UpdateTexture(r->texture, &used, r->pixels, r->width * sizeof(uint32_t));
+    }
+    else
+    {
+        for (int i = 0; i < r->rects; i++)
+        {
+            const SDL_Rect* rect = &r->dirty[i];
+            const uint32_t* start = &r->pixels[(size_t)r->width * rect->y + rect->x];
+
+            SDL_UpdateTexture(r->texture, rect, start, r->width * sizeof(uint32_t));
+        }
+    }
+
+    r->rects = 0;
+    r->upload_all = 0;
+
+    // Copy the texture to the renderer to render it, scaling it up to fill
+    // the window if needed. The last row and column of texels can hang off
+    // the edge of the window.
+    int scale = r->gpu_scale ? r->zoom : 1;
+    SDL_Rect screen = { 0, 0, used.w * scale, used.h * scale };
+
+    SDL_RenderCopy(r->renderer, r->texture, &used, &screen);
+}
@@ -0,0 +1,187 @@
+/* render.h - Drawing the grid
+ *
+ * Drawing to the screen is done by indirectly modifying the screen buffer.
+ * We keep a texture with streaming access so we can change the pixels in it,
+ * the screen buffer is the pixel data which gets copied into the texture,
+ * which then gets copied to the renderer.
+ *
+ * The window is a view into the grid, which can be moved around and zoomed
+ * in and out. Zoomed in, every cell is zoom x zoom pixels. Zoomed out, every
+ * pixel is a block of 2^shift x 2^shift cells, drawn brighter the more of
+ * them are alive. The blocks get counted by the engine (see count_blocks in
+ * engine.h), which knows how to do that without looking at every cell, so
+ * drawing takes about as long as there are pixels on screen no matter how
+ * big the grid is.
+ *
+ * By default the texture has one texel per cell (or block) in the view, and
+ * the GPU scales it up to the window with nearest neighbor filtering when it
+ * gets copied to the renderer. It can also be drawn the old way, where every
+ * cell gets filled in as a zoom x zoom block in a window sized texture.
+ *
+ * Only the texels that changed since the last frame get redrawn. The view is
+ * split into bands of rows, and for every band the columns between the
+ * first and last changed texel get repainted and uploaded to the texture. If
+ * most of the screen changed it's cheaper to just upload all of it. Moving
+ * or zooming the view redraws everything.
+ *
+ * Engines that keep the grid on the GPU get drawn straight from there
+ * instead, if the renderer can (see gpuview.h), and none of the above
+ * happens.
+*/
+
+#ifndef RENDER_H
+#define RENDER_H
+
+#include <SDL2/SDL.h>
+#include <stdint.h>
+#include "engine.h"
+
+// How many rows of texels share one dirty rectangle
+#define RENDER_BAND_ROWS 8
+
+// Most pixels a cell can get zoomed in to
+#define RENDER_MAX_ZOOM 64
+
+// Zoomed out, a block with anything alive in it is at least this bright so
+// a lone glider doesn't disappear, and it gets brighter the fuller it is
+#define RENDER_DIM 96
+
+// Most cells a pixel can get zoomed out to is 2^RENDER_MAX_SHIFT across, which
+// keeps the count of a block in 32 bits
+#define RENDER_MAX_SHIFT 15
+
+// How many cells are alive in every texel of a view, so they can be counted
+// on a different thread than the one drawing them (see pipeline.h)
+typedef struct
+{
+    // Which texels: block (bx, by) of 2^shift x 2^shift cells is in the top
+    // left corner, and there are columns x rows of them
+    int shift;
+    int bx;
+    int by;
+    int columns;
+    int rows;
+
+    // Generation they were counted in, and the engine's census of it (see
+    // engine_census()), changes is what that returned
+    uint64_t generation;
+    census counted;
+    int changes;
+
+    // Row by row, columns x rows of them
+    uint32_t* counts;
+} render_frame;
+
+typedef struct
+{
+    SDL_Renderer* renderer;
+    SDL_Texture* texture;
+
+    int grid_width;
+    int grid_height;
+
+    // The view can go past the edges of the grid, for engines where there's
+    // something out there
+    int unbounded;
+
+    // Window size in pixels
+    int window_width;
+    int window_height;
+
+    // Cell (view_x, view_y) is in the top left corner of the window. Every
+    // texel is 2^shift x 2^shift cells, and zoom x zoom pixels on screen.
+    // Only one of them is ever more than 1 (or 0 for shift).
+    int view_x;
+    int view_y;
+    int zoom;
+    int shift;
+
+    // Panned by less than a texel so far, in pixels
+    int pan_x;
+    int pan_y;
+
+    // Texels across and down the view, enough to cover the whole window
+    int columns;
+    int rows;
+
+    // Let the GPU scale texels up to the window, instead of filling in
+    // zoom x zoom pixels for each of them
+    int gpu_scale;
+
+    // How many pixels across each texel is in the texture, 1 if the GPU is
+    // doing the scaling and zoom otherwise
+    int cell_size;
+
+    // Texture size in pixels, always the window size
+    int width;
+    int height;
+
+    // Screen buffer, width x height
+    uint32_t* pixels;
+
+    // How many cells are alive in every texel as it's currently drawn, with
+    // a row of width of them for every row of the view
+    uint32_t* shown;
+
+    // One row of texels counted by the engine
+    uint32_t* counts;
+
+    // Dirty rectangles for this frame, one per band at most
+    SDL_Rect* dirty;
+    int rects;
+
+    // Live cells in view, kept up to date as texels get repainted.
+    // UINT64_MAX when drawing from the GPU, where nobody counts them.
+    uint64_t population;
+
+    // Redraw and upload everything next frame
+    int full;
+
+    // Enough changed this frame that uploading all of it is cheaper
+    int upload_all;
+
+    // Set if the grid gets drawn from the engine's texture, which is
+    // gpu_texture this frame
+    struct gpuview* gpu;
+    unsigned int gpu_texture;
+} render;
+
+// Starts out showing the grid with every cell pixel_size pixels, or zoomed
+// out to fit the window if it doesn't fit like that.
+// Returns 1 on success, 0 if the texture or buffers couldn't be created
+int render_init(render* r, SDL_Renderer* renderer, const engine* sim, int window_width, int window_height, int pixel_size, int gpu_scale);
+void render_free(render* r);
+
+// Paint every texel that changed into the screen buffer
+void render_paint(render* r, engine* sim);
+
+// Fill in which texels are in view right now, everything but the counts
+void render_view(const render* r, render_frame* f);
+
+// Count the texels of f's view, f->counts has to have room for all of them.
+// Takes a census too.
+void render_count(render_frame* f, engine* sim);
+
+// Same as render_paint(), from texels counted with render_count(). Returns
+// 0 without painting anything if the view has moved since they were
+// counted, so the last frame stays up until there are counts for it.
+int render_paint_frame(render* r, const render_frame* f);
+
+// Upload what render_paint() changed to the texture and copy it to the
+// renderer, ready for SDL_RenderPresent()
+void render_upload(render* r);
+
+// Move the view by this many pixels
+void render_pan(render* r, int dx, int dy);
+
+// Zoom in by steps (zoom out if negative), twice as far for every step,
+// keeping whatever is under pixel (x, y) where it is
+void render_zoom(render* r, int steps, int x, int y);
+
+// Zoom so the whole grid fits in the window, and center it
+void render_fit(render* r);
+
+// Which cell is under pixel (x, y) of the window
+void render_cell_at(const render* r, int x, int y, int* cx, int* cy);
+
+#endif
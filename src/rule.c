@@ -0,0 +1,95 @@
+/* rule.c - Life-like rules
+*/
+
+#include <SDL2/SDL.h>
+#include <stdio.h>
+#include <string.h>
+#include "rule.h"
+
+const rule rule_life = { RULE_LIFE_BIRTH, RULE_LIFE_SURVIVE };
+
+typedef struct
+{
+    const char* name;
+    const char* text;
+} named_rule;
+
+static const named_rule names[] =
+{
+    { "life", "B3/S23" },
+    { "highlife", "B36/S23" },
+    { "seeds", "B2/S" },
+    { "daynight", "B3678/S34678" },
+    { "day&night", "B3678/S34678" },
+};
+
+// Digits 0 to 8 into a mask, up to the first character that isn't one
+static const char* parse_counts(const char* text, uint16_t* mask)
+{
+    *mask = 0;
+
+    while (*text >= '0' && *text <= '8')
+    {
+        *mask |= 1 << (*text - '0');
+        text++;
+    }
+
+    return text;
+}
+
+int rule_parse(const char* text, rule* out)
+{
+    for (size_t i = 0; i < SDL_arraysize(names); i++)
+    {
+        if (SDL_strcasecmp(text, names[i].name) == 0)
+            text = names[i].text;
+    }
+
+    rule r;
+    const char* p = text;
+
+    if (*p == 'B' || *p == 'b')
+    {
+        // B3/S23
+        p = parse_counts(p + 1, &r.birth);
+
+        if (*p++ != '/' || (*p != 'S' && *p != 's'))
+            return 0;
+
+        p = parse_counts(p + 1, &r.survive);
+    }
+    else
+    {
+        // 23/3, survival first
+        p = parse_counts(p, &r.survive);
+
+        if (*p++ != '/')
+            return 0;
+
+        p = parse_counts(p, &r.birth);
+    }
+
+    if (*p != '\0' || (r.birth & 1))
+        return 0;
+
+    *out = r;
+    return 1;
+}
+
+void rule_format(const rule* r, char* out, size_t size)
+{
+    char birth[10];
+    char survive[10];
+    int b = 0;
+    int s = 0;
+
+    for (int n = 0; n <= 8; n++)
+    {
+        if (r->birth >> n & 1)
+            birth[b++] = (char)('0' + n);
+        if (r->survive >> n & 1)
+            survive[s++] = (char)('0' + n);
+    }
+
+    snprintf(out, size, "B%.*s/S%.*s", b, birth, s, survive);
+}
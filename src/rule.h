@@ -0,0 +1,92 @@
+/* rule.h - Life-like rules
+ *
+ * Every Life-like rule comes down to two sets of neighbor counts: the
+ * counts that bring a dead cell to life (birth) and the counts that keep a
+ * live cell alive (survival). They're written like "B3/S23", which is
+ * Conway's Life, and stored as masks with bit n set for every count n in
+ * the set. The older "S/B" way of writing them ("23/3") works too, and so
+ * do the names of the rules we have specialized kernels for.
+ *
+ * Kernels are written once with the rule as arguments, and copied out for
+ * every rule in RULE_SPECIALIZED with the masks as constants, so the
+ * compiler can throw away every count the rule doesn't use. Any other rule
+ * gets the same kernel with the masks looked up at runtime. For Life the
+ * kernels keep their old hand-written math, so the default rule costs
+ * exactly what it did before rules could be changed.
+ *
+ * Rules with B0 aren't supported. They bring empty space to life, so the
+ * dead cells past the edge of the grid (and the empty universe hashlife
+ * skips) wouldn't be dead anymore.
+*/
+
+#ifndef RULE_H
+#define RULE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define RULE_LIFE_BIRTH 0x008
+#define RULE_LIFE_SURVIVE 0x00C
+
+// Rules that get their own copy of every kernel: name, birth and survival
+#define RULE_SPECIALIZED(X) \
+    X(life, RULE_LIFE_BIRTH, RULE_LIFE_SURVIVE) \
+    X(highlife, 0x048, 0x00C) \
+    X(seeds, 0x004, 0x000) \
+    X(daynight, 0x1C8, 0x1D8)
+
+// Makes sure a kernel really is copied into every specialized version,
+// otherwise the masks aren't constants in it
+#if defined(__GNUC__) || defined(__clang__)
+#define RULE_INLINE static inline __attribute__((always_inline))
+#elif defined(_MSC_VER)
+#define RULE_INLINE static __forceinline
+#else
+#define RULE_INLINE static inline
+#endif
+
+// Goes right before the loops over every neighbor count in the kernels.
+// Left as a loop, the compiler keeps it around even when all but one count
+// is thrown away.
+#if defined(__GNUC__) || defined(__clang__)
+#define RULE_UNROLL _Pragma("GCC unroll 9")
+#else
+#define RULE_UNROLL
+#endif
+
+typedef struct
+{
+    // Bit n is set if n neighbors brings a dead cell to life/keeps a live
+    // one alive
+    uint16_t birth;
+    uint16_t survive;
+} rule;
+
+// Conway's Life, B3/S23
+extern const rule rule_life;
+
+// Parse a rule like "B36/S23", "23/36" or "highlife". Returns 1 on
+// success, 0 if it isn't a valid rule or has B0.
+int rule_parse(const char* text, rule* out);
+
+// Write the rule as "B36/S23"
+void rule_format(const rule* r, char* out, size_t size);
+
+static inline int rule_equal(const rule* a, const rule* b)
+{
+    return a->birth == b->birth && a->survive == b->survive;
+}
+
+static inline int rule_is_life(const rule* r)
+{
+    return r->birth == RULE_LIFE_BIRTH && r->survive == RULE_LIFE_SURVIVE;
+}
+
+// Is a cell alive next generation with n live neighbors? This is the
+// lookup table for the generic kernels.
+static inline int rule_next(unsigned birth, unsigned survive, int alive, int n)
+{
+    return ((alive ? survive : birth) >> n) & 1;
+}
+
+#endif
@@ -0,0 +1,379 @@
+/* savefile.c - Saving and loading .gol files
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "savefile.h"
+#include "mapfile.h"
+
+#define HEADER_SIZE 24
+
+// Bigger stdio buffer for saving, so a whole file goes out in a few big
+// writes instead of thousands of small ones
+#define FILE_BUFFER_SIZE (1 << 16)
+
+static const uint8_t magic[4] = { 'G', 'o', 'L', 0x1A };
+
+// Where the rows being saved come from, an engine, a copy of its grid or
+// someone handing them over a row at a time
+typedef struct
+{
+    engine* e;
+    const uint8_t* cells;
+    savefile_rows rows;
+    void* data;
+    int width;
+    int height;
+} row_source;
+
+static void get_row(const row_source* src, int y, uint8_t* out)
+{
+    if (src->rows)
+    {
+        src->rows(src->data, y, out);
+        return;
+    }
+
+    if (src->e)
+    {
+        src->e->get_row(src->e, y, out);
+        return;
+    }
+
+    const uint8_t* row = &src->cells[(size_t)src->width * y];
+
+    for (int x = 0; x < src->width; x++)
+    {
+        out[x] = row[x] & CELL_ALIVE;
+    }
+}
+
+static void put_le(uint8_t* out, uint64_t value, int bytes)
+{
+    for (int i = 0; i < bytes; i++)
+    {
+        out[i] = (uint8_t)(value >> (8 * i));
+    }
+}
+
+static uint64_t get_le(const uint8_t* in, int bytes)
+{
+    uint64_t value = 0;
+
+    for (int i = 0; i < bytes; i++)
+    {
+        value |= (uint64_t)in[i] << (8 * i);
+    }
+
+    return value;
+}
+
+static size_t varint_size(uint64_t value)
+{
+    size_t size = 1;
+
+    while (value >= 0x80)
+    {
+        value >>= 7;
+        size++;
+    }
+
+    return size;
+}
+
+static void write_varint(FILE* fp, uint64_t value)
+{
+    while (value >= 0x80)
+    {
+        fputc((int)(value & 0x7F) | 0x80, fp);
+        value >>= 7;
+    }
+
+    fputc((int)value, fp);
+}
+
+// Go through every run of dead or live cells in the grid. If fp is NULL
+// nothing gets written, it only adds up how big the runs would be.
+static size_t write_runs(const row_source* src, uint8_t* row, FILE* fp)
+{
+    size_t size = 0;
+    uint64_t run = 0;
+    uint8_t alive = 0;
+
+    for (int y = 0; y < src->height; y++)
+    {
+        get_row(src, y, row);
+
+        for (int x = 0; x < src->width; x++)
+        {
+            if (row[x] == alive)
+            {
+                run++;
+                continue;
+            }
+
+            size += varint_size(run);
+            if (fp)
+                write_varint(fp, run);
+
+            alive = row[x];
+            run = 1;
+        }
+    }
+
+    size += varint_size(run);
+    if (fp)
+        write_varint(fp, run);
+
+    return size;
+}
+
+static int write_packed(const row_source* src, uint8_t* row, FILE* fp)
+{
+    size_t bytes = ((size_t)src->width + 7) / 8;
+    uint8_t* packed = malloc(bytes);
+    int ok = packed != NULL;
+
+    for (int y = 0; ok && y < src->height; y++)
+    {
+        get_row(src, y, row);
+        memset(packed, 0, bytes);
+
+        for (int x = 0; x < src->width; x++)
+        {
+            packed[x >> 3] |= row[x] << (x & 7);
+        }
+
+        ok = fwrite(packed, 1, bytes, fp) == bytes;
+    }
+
+    free(packed);
+    return ok;
+}
+
+static int save(const char* path, const row_source* src, uint64_t generation)
+{
+    // Go a row at a time so huge grids don't need a second copy in memory
+    uint8_t* row = malloc(src->width);
+    if (!row)
+        return 0;
+
+    // Dense grids come out smaller packed, sparse ones as runs
+    size_t packed_size = ((size_t)src->width + 7) / 8 * src->height;
+    int encoding = write_runs(src, row, NULL) < packed_size ? SAVEFILE_RLE : SAVEFILE_PACKED;
+
+    FILE* fp = fopen(path, "w+b");
+    if (!fp)
+    {
+        free(row);
+        return 0;
+    }
+
+    setvbuf(fp, NULL, _IOFBF, FILE_BUFFER_SIZE);
+
+    uint8_t header[HEADER_SIZE];
+    memcpy(header, magic, sizeof(magic));
+    put_le(&header[4], SAVEFILE_VERSION, 2);
+    put_le(&header[6], encoding, 2);
+    put_le(&header[8], src->width, 4);
+    put_le(&header[12], src->height, 4);
+    put_le(&header[16], generation, 8);
+
+    int ok = fwrite(header, 1, HEADER_SIZE, fp) == HEADER_SIZE;
+
+    if (ok && encoding == SAVEFILE_RLE)
+        write_runs(src, row, fp);
+    else if (ok)
+        ok = write_packed(src, row, fp);
+
+    free(row);
+
+    // Close it to prevent any issues, this is also where a failed write of
+    // the runs shows up
+    if (ferror(fp))
+        ok = 0;
+    if (fclose(fp) != 0)
+        ok = 0;
+
+    return ok;
+}
+
+int savefile_save(const char* path, engine* e)
+{
+    row_source src = { e, NULL, NULL, NULL, e->width, e->height };
+    return save(path, &src, e->generation);
+}
+
+int savefile_write(const char* path, const uint8_t* cells, int width, int height, uint64_t generation)
+{
+    row_source src = { NULL, cells, NULL, NULL, width, height };
+    return save(path, &src, generation);
+}
+
+int savefile_stream(const char* path, int width, int height, uint64_t generation, savefile_rows rows, void* data)
+{
+    row_source src = { NULL, NULL, rows, data, width, height };
+    return save(path, &src, generation);
+}
+
+// Only the part of the file that fits in the grid gets loaded. Without
+// load set, both of these only check that the body is all there, so a
+// broken file can be turned down before the grid gets cleared.
+static int load_packed(const uint8_t* data, size_t size, engine* e, uint32_t width, uint32_t height, int load)
+{
+    size_t bytes = ((size_t)width + 7) / 8;
+    int w = (uint32_t)e->width < width ? e->width : (int)width;
+    int h = (uint32_t)e->height < height ? e->height : (int)height;
+
+    // Rows past the bottom of the grid don't matter, so they aren't touched
+    if (size / bytes < (size_t)h)
+        return 0;
+
+    for (int y = 0; load && y < h; y++)
+    {
+        engine_load_row_bits(e, y, &data[bytes * y], w);
+    }
+
+    return 1;
+}
+
+static int read_varint(const uint8_t** p, const uint8_t* end, uint64_t* value)
+{
+    *value = 0;
+
+    for (int shift = 0; shift < 64 && *p < end; shift += 7)
+    {
+        uint8_t c = *(*p)++;
+        *value |= (uint64_t)(c & 0x7F) << shift;
+
+        if (!(c & 0x80))
+            return 1;
+    }
+
+    return 0;
+}
+
+static int load_runs(const uint8_t* data, size_t size, engine* e, uint32_t width, uint32_t height, int load)
+{
+    const uint8_t* p = data;
+    const uint8_t* end = data + size;
+    uint64_t total = (uint64_t)width * height;
+    uint64_t pos = 0;
+    int alive = 0;
+
+    while (pos < total)
+    {
+        uint64_t run;
+
+        if (!read_varint(&p, end, &run) || run > total - pos)
+            return 0;
+
+        // Dead runs are already dead, only live ones need setting
+        if (alive && load)
+        {
+            uint64_t x = pos % width;
+            uint64_t y = pos / width;
+
+            for (uint64_t i = 0; i < run && y < (uint64_t)e->height; i++)
+            {
+                if (x < (uint64_t)e->width)
+                    e->set_cell(e, (int)x, (int)y, 1);
+
+                if (++x == width)
+                {
+                    x = 0;
+                    y++;
+                }
+            }
+        }
+
+        pos += run;
+        alive = !alive;
+    }
+
+    return 1;
+}
+
+// Files from before there was a header, one byte per cell
+static void load_raw(const uint8_t* data, size_t size, engine* e)
+{
+    for (int y = 0; y < e->height; y++)
+    {
+        size_t offset = (size_t)e->width * y;
+
+        if (offset >= size)
+            break;
+
+        const uint8_t* row = &data[offset];
+        size_t got = size - offset < (size_t)e->width ? size - offset : (size_t)e->width;
+
+        // Old save files can still have the revive/die bits set, only
+        // the alive bit matters
+        for (size_t x = 0; x < got; x++)
+        {
+            if (row[x] & CELL_ALIVE)
+                e->set_cell(e, (int)x, y, 1);
+        }
+    }
+}
+
+int savefile_load(const char* path, engine* e)
+{
+    // The file is mapped instead of read, so the cells go straight from the
+    // OS file cache into the grid without being copied into a buffer first
+    mapfile file;
+
+    if (!mapfile_open(&file, path))
+        return 0;
+
+    const uint8_t* header = file.data;
+    int ok = 1;
+
+    // Cells in old files are only ever 0 to 7, so they can't start with the
+    // magic by accident
+    if (file.size >= sizeof(magic) && memcmp(header, magic, sizeof(magic)) == 0)
+    {
+        ok = file.size >= HEADER_SIZE;
+
+        uint32_t version = ok ? (uint32_t)get_le(&header[4], 2) : 0;
+        uint32_t encoding = ok ? (uint32_t)get_le(&header[6], 2) : 0;
+        uint32_t width = ok ? (uint32_t)get_le(&header[8], 4) : 0;
+        uint32_t height = ok ? (uint32_t)get_le(&header[12], 4) : 0;
+
+        ok = ok && version == SAVEFILE_VERSION && width > 0 && height > 0
+            && (encoding == SAVEFILE_PACKED || encoding == SAVEFILE_RLE);
+
+        if (ok)
+        {
+            const uint8_t* body = &file.data[HEADER_SIZE];
+            size_t size = file.size - HEADER_SIZE;
+            int runs = encoding == SAVEFILE_RLE;
+
+            // Check it all first, a cut off or broken file leaves the grid
+            // the way it was
+            ok = runs ? load_runs(body, size, e, width, height, 0) : load_packed(body, size, e, width, height, 0);
+
+            if (ok)
+            {
+                e->clear(e);
+                e->generation = get_le(&header[16], 8);
+
+                if (runs)
+                    load_runs(body, size, e, width, height, 1);
+                else
+                    load_packed(body, size, e, width, height, 1);
+            }
+        }
+    }
+    else
+    {
+        e->clear(e);
+        e->generation = 0;
+        load_raw(file.data, file.size, e);
+    }
+
+    mapfile_close(&file);
+
+    return ok;
+}
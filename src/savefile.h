@@ -0,0 +1,56 @@
+/* savefile.h - Saving and loading .gol files
+ *
+ * A .gol file starts with a 24 byte header, all numbers little endian:
+ *
+ *   0  magic      "GoL" and 0x1A
+ *   4  version    uint16, 2
+ *   6  encoding   uint16, SAVEFILE_PACKED or SAVEFILE_RLE
+ *   8  width      uint32
+ *  12  height     uint32
+ *  16  generation uint64
+ *
+ * After that comes the grid, in whichever encoding came out smaller:
+ *
+ *  - packed: one bit per cell, row by row. Every row starts on a new byte,
+ *    and cell x is bit (x % 8) of byte (x / 8).
+ *  - rle: the whole grid in order as runs of dead and live cells, starting
+ *    with dead. Each run is a length stored 7 bits at a time, low bits
+ *    first, with the top bit set on every byte except the last one. Mostly
+ *    empty grids come down to a handful of bytes.
+ *
+ * Old files without a header (one byte per cell, CELL_ALIVE set for every
+ * live cell) still load, as long as the grid is the same width as when they
+ * were saved.
+*/
+
+#ifndef SAVEFILE_H
+#define SAVEFILE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "engine.h"
+
+#define SAVEFILE_VERSION 2
+
+#define SAVEFILE_PACKED 0
+#define SAVEFILE_RLE 1
+
+// Save/load an engine's grid, including its generation. A file with a
+// different size than the grid is cut off or padded with dead cells.
+// Returns 1 on success, 0 if the file couldn't be opened, written, or isn't
+// a valid .gol file. A file that doesn't load leaves the grid alone.
+int savefile_save(const char* path, engine* e);
+int savefile_load(const char* path, engine* e);
+
+// Save a grid that was copied out of an engine with engine_store()
+int savefile_write(const char* path, const uint8_t* cells, int width, int height, uint64_t generation);
+
+// Fills out with row y of the grid, one byte per cell and 1 for alive
+typedef void (*savefile_rows)(void* data, int y, uint8_t* out);
+
+// Save a grid nobody has all of at once, that rows hands over a row at a
+// time. It gets asked for every row in order from the top, twice, once to
+// see which encoding comes out smaller and once to write it.
+int savefile_stream(const char* path, int width, int height, uint64_t generation, savefile_rows rows, void* data);
+
+#endif
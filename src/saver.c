@@ -0,0 +1,219 @@
+/* saver.c - Saving in the background
+*/
+
+#include <SDL2/SDL.h>
+#include <stdlib.h>
+#include <string.h>
+#include "saver.h"
+#include "savefile.h"
+
+struct saver
+{
+    SDL_Thread* thread;
+    SDL_mutex* lock;
+
+    // Signalled when there is something to write, or when it is time to quit
+    SDL_cond* wake;
+
+    // Signalled when a save is done
+    SDL_cond* idle;
+
+    int busy;
+    int quit;
+
+    // Set when a save is done, until saver_finished() picks it up
+    int finished;
+    int ok;
+
+    // The copy being written, only touched by the thread while busy
+    uint8_t* cells;
+    size_t capacity;
+    int width;
+    int height;
+    uint64_t generation;
+    char* path;
+};
+
+static int saver_main(void* data)
+{
+    saver* s = data;
+
+    SDL_LockMutex(s->lock);
+
+    while (1)
+    {
+        while (!s->busy && !s->quit)
+            SDL_CondWait(s->wake, s->lock);
+
+        if (!s->busy)
+            break;
+
+        SDL_UnlockMutex(s->lock);
+        int ok = savefile_write(s->path, s->cells, s->width, s->height, s->generation);
+        SDL_LockMutex(s->lock);
+
+        s->busy = 0;
+        s->finished = 1;
+        s->ok = ok;
+        SDL_CondBroadcast(s->idle);
+    }
+
+    SDL_UnlockMutex(s->lock);
+    return 0;
+}
+
+saver* saver_create(void)
+{
+    saver* s = calloc(1, sizeof(saver));
+    if (!s)
+        return NULL;
+
+    s->ok = 1;
+    s->lock = SDL_CreateMutex();
+    s->wake = SDL_CreateCond();
+    s->idle = SDL_CreateCond();
+
+    if (s->lock && s->wake && s->idle)
+        s->thread = SDL_CreateThread(saver_main, "gol saver", s);
+
+    if (!s->thread)
+    {
+        saver_destroy(s);
+        return NULL;
+    }
+
+    return s;
+}
+
+void saver_destroy(saver* s)
+{
+    if (!s)
+        return;
+
+    if (s->thread)
+    {
+        SDL_LockMutex(s->lock);
+        s->quit = 1;
+        SDL_CondSignal(s->wake);
+        SDL_UnlockMutex(s->lock);
+
+        // Anything still being written gets finished first
+        SDL_WaitThread(s->thread, NULL);
+    }
+
+    if (s->idle)
+        SDL_DestroyCond(s->idle);
+    if (s->wake)
+        SDL_DestroyCond(s->wake);
+    if (s->lock)
+        SDL_DestroyMutex(s->lock);
+
+    free(s->cells);
+    free(s->path);
+    free(s);
+}
+
+// Get the buffer and path ready for the next save, only called while the
+// thread is idle
+static int saver_prepare(saver* s, int width, int height, const char* path)
+{
+    size_t size = (size_t)width * height;
+
+    if (size > s->capacity)
+    {
+        uint8_t* cells = realloc(s->cells, size);
+        if (!cells)
+            return 0;
+
+        s->cells = cells;
+        s->capacity = size;
+    }
+
+    char* copy = malloc(strlen(path) + 1);
+    if (!copy)
+        return 0;
+
+    strcpy(copy, path);
+    free(s->path);
+    s->path = copy;
+
+    s->width = width;
+    s->height = height;
+    return 1;
+}
+
+static int saver_busy(saver* s)
+{
+    SDL_LockMutex(s->lock);
+    int busy = s->busy;
+    SDL_UnlockMutex(s->lock);
+
+    return busy;
+}
+
+static void saver_start(saver* s, uint64_t generation)
+{
+    SDL_LockMutex(s->lock);
+    s->generation = generation;
+    s->busy = 1;
+    SDL_CondSignal(s->wake);
+    SDL_UnlockMutex(s->lock);
+}
+
+int saver_save(saver* s, engine* e, const char* path)
+{
+    if (saver_busy(s) || !saver_prepare(s, e->width, e->height, path))
+        return 0;
+
+    // The only part that holds up the caller, one pass over the grid
+    engine_store(e, s->cells);
+
+    saver_start(s, e->generation);
+    return 1;
+}
+
+int saver_save_bits(saver* s, const uint8_t* bits, int width, int height, uint64_t generation, const char* path)
+{
+    if (saver_busy(s) || !saver_prepare(s, width, height, path))
+        return 0;
+
+    size_t row_bytes = ((size_t)width + 7) / 8;
+
+    for (int y = 0; y < height; y++)
+    {
+        const uint8_t* row = &bits[row_bytes * y];
+        uint8_t* cells = &s->cells[(size_t)width * y];
+
+        for (int x = 0; x < width; x++)
+        {
+            cells[x] = (row[x >> 3] >> (x & 7)) & 1;
+        }
+    }
+
+    saver_start(s, generation);
+    return 1;
+}
+
+int saver_finished(saver* s, int* ok)
+{
+    SDL_LockMutex(s->lock);
+    int finished = s->finished;
+    *ok = s->ok;
+    s->finished = 0;
+    SDL_UnlockMutex(s->lock);
+
+    return finished;
+}
+
+int saver_wait(saver* s)
+{
+    SDL_LockMutex(s->lock);
+
+    while (s->busy)
+        SDL_CondWait(s->idle, s->lock);
+
+    int ok = s->ok;
+    SDL_UnlockMutex(s->lock);
+
+    return ok;
+}
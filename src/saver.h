@@ -0,0 +1,38 @@
+/* saver.h - Saving in the background
+ *
+ * Writing a big grid to disk takes a while, so instead of making whoever
+ * wants to save wait for it, the grid is copied out of the engine and a
+ * thread writes the copy while the simulation keeps going. Only one save
+ * can be in flight at a time.
+*/
+
+#ifndef SAVER_H
+#define SAVER_H
+
+#include <stdint.h>
+#include "engine.h"
+
+typedef struct saver saver;
+
+// Start the saving thread, returns NULL if it couldn't be started
+saver* saver_create(void);
+
+// Wait for the last save to finish and stop the thread
+void saver_destroy(saver* s);
+
+// Copy the grid out of the engine (or the one given as bits, rows of
+// (width + 7) / 8 bytes with cell x in bit (x % 8) of byte (x / 8), like
+// history_kept() has them) and start writing it to path. Returns 0 without
+// doing anything if the last save is still being written or there isn't
+// enough memory for the copy.
+int saver_save(saver* s, engine* e, const char* path);
+int saver_save_bits(saver* s, const uint8_t* bits, int width, int height, uint64_t generation, const char* path);
+
+// Returns 1 once per finished save, with ok set to whether it worked, and
+// 0 if nothing finished since the last call
+int saver_finished(saver* s, int* ok);
+
+// Block until the last save is done, returns 1 if it worked
+int saver_wait(saver* s);
+
+#endif
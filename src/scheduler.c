@@ -0,0 +1,86 @@
+/* scheduler.c - Simulation speed
+*/
+
+#include <SDL2/SDL.h>
+#include "scheduler.h"
+
+void scheduler_init(scheduler* s, int rate, uint64_t jump)
+{
+    s->rate = rate;
+    s->jump = jump;
+    s->record = NULL;
+    scheduler_reset(s);
+}
+
+void scheduler_faster(scheduler* s)
+{
+    if (s->rate == 0)
+        return;
+
+    s->rate *= 2;
+
+    if (s->rate > SCHEDULER_MAX_RATE)
+        s->rate = 0;
+}
+
+void scheduler_slower(scheduler* s)
+{
+    if (s->rate == 0)
+        s->rate = SCHEDULER_MAX_RATE;
+    else if (s->rate > SCHEDULER_MIN_RATE)
+        s->rate /= 2;
+}
+
+void scheduler_reset(scheduler* s)
+{
+    s->owed = 0;
+    s->last = SDL_GetPerformanceCounter();
+}
+
+int scheduler_run(scheduler* s, engine* sim, double budget)
+{
+    uint64_t freq = SDL_GetPerformanceFrequency();
+    uint64_t now = SDL_GetPerformanceCounter();
+    uint64_t deadline = now + (uint64_t)(budget * freq);
+
+    if (s->rate > 0)
+        s->owed += (double)(now - s->last) / freq * s->rate;
+
+    s->last = now;
+
+    int stepped = 0;
+
+    // With no set speed, keep going until we run out of time
+    while (s->rate == 0 || s->owed >= 1)
+    {
+        engine_advance(sim, s->jump);
+        stepped++;
+
+        if (s->rate > 0)
+            s->owed -= 1;
+
+        if (SDL_GetPerformanceCounter() >= deadline)
+            break;
+    }
+
+    // If the engine can't keep up, drop what's left instead of piling it up
+    // forever and trying to catch up later
+    if (s->owed >= 1)
+        s->owed = 0;
+
+    if (s->record && stepped > 0)
+        history_record(s->record, sim);
+
+    return stepped;
+}
+
+double scheduler_wait(const scheduler* s)
+{
+    if (s->rate == 0)
+        return 0;
+
+    double since = (double)(SDL_GetPerformanceCounter() - s->last) / SDL_GetPerformanceFrequency();
+    double wait = (1 - s->owed) / s->rate - since;
+
+    return wait > 0 ? wait : 0;
+}
@@ -0,0 +1,61 @@
+/* scheduler.h - Simulation speed
+ *
+ * Keeps the simulation running at a set number of generations per second,
+ * no matter how fast the screen is being drawn. Every frame it works out
+ * how many generations are owed since the last frame and steps them all,
+ * so a 60 Hz screen can still show the simulation running at thousands of
+ * generations per second. The speed can also be unlimited, which just
+ * steps for as long as a frame allows.
+*/
+
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <stdint.h>
+#include "engine.h"
+#include "history.h"
+
+// Slowest and fastest set speeds, going past the fastest means unlimited
+#define SCHEDULER_MIN_RATE 1
+#define SCHEDULER_MAX_RATE 65536
+
+#define SCHEDULER_DEFAULT_RATE 32
+
+typedef struct
+{
+    // Steps per second, 0 is as fast as possible
+    int rate;
+
+    // Generations in every step
+    uint64_t jump;
+
+    // Generations that are due but haven't been stepped yet
+    double owed;
+
+    // When scheduler_run() was last called
+    uint64_t last;
+
+    // If set, the last step of every scheduler_run() gets recorded here so
+    // it can be undone. Recording every one of thousands of steps a frame
+    // would take longer than stepping them.
+    history* record;
+} scheduler;
+
+void scheduler_init(scheduler* s, int rate, uint64_t jump);
+
+// Double or halve the speed
+void scheduler_faster(scheduler* s);
+void scheduler_slower(scheduler* s);
+
+// Forget about any time that passed, call this while paused so the
+// simulation doesn't try to catch up when started again
+void scheduler_reset(scheduler* s);
+
+// Step every generation that is due, but give up after budget seconds so
+// the window stays responsive. Returns how many steps were done.
+int scheduler_run(scheduler* s, engine* sim, double budget);
+
+// Seconds until the next step is due, 0 if it already is
+double scheduler_wait(const scheduler* s);
+
+#endif
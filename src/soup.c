@@ -0,0 +1,36 @@
+/* soup.c - Random soups
+*/
+
+#include "soup.h"
+
+uint64_t soup_random(uint64_t* state)
+{
+    uint64_t x = *state;
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    *state = x;
+    return x * 0x2545F4914F6CDD1DULL;
+}
+
+void soup_fill(engine* e, uint64_t seed, double density, int x, int y, int w, int h)
+{
+    // Mix the seed up a bit, so seeds next to each other don't start out
+    // looking the same. It can't be 0 either.
+    uint64_t state = seed * 0x9E3779B97F4A7C15ULL + 1;
+    uint64_t threshold = (uint64_t)(density * 18446744073709551615.0);
+
+    if (density >= 1)
+        threshold = UINT64_MAX;
+
+    e->clear(e);
+
+    for (int cy = y; cy < y + h; cy++)
+    {
+        for (int cx = x; cx < x + w; cx++)
+        {
+            if (soup_random(&state) < threshold)
+                e->set_cell(e, cx, cy, 1);
+        }
+    }
+}
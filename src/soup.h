@@ -0,0 +1,20 @@
+/* soup.h - Random soups
+ *
+ * Fills grids with random cells from a small PRNG (xorshift64*) instead of
+ * rand(), so the same seed makes the exact same soup on every platform.
+*/
+
+#ifndef SOUP_H
+#define SOUP_H
+
+#include <stdint.h>
+#include "engine.h"
+
+// Next random number, state must never be 0
+uint64_t soup_random(uint64_t* state);
+
+// Kill everything, then make each cell in the w x h box at (x, y) alive with
+// a chance of density (0 to 1)
+void soup_fill(engine* e, uint64_t seed, double density, int x, int y, int w, int h);
+
+#endif
@@ -0,0 +1,38 @@
+/* stats.c - Timing where the time goes
+*/
+
+#include <SDL2/SDL.h>
+#include <string.h>
+#include "stats.h"
+
+void stats_start(stats* s)
+{
+    memset(s->ticks, 0, sizeof(s->ticks));
+    s->freq = SDL_GetPerformanceFrequency();
+    s->mark = SDL_GetPerformanceCounter();
+}
+
+void stats_lap(stats* s, int phase)
+{
+    uint64_t now = SDL_GetPerformanceCounter();
+
+    s->ticks[phase] += now - s->mark;
+    s->mark = now;
+}
+
+double stats_ms(const stats* s, int phase)
+{
+    return s->ticks[phase] * 1000.0 / s->freq;
+}
+
+double stats_seconds(const stats* s)
+{
+    uint64_t total = 0;
+
+    for (int i = 0; i < STATS_PHASES; i++)
+    {
+        total += s->ticks[i];
+    }
+
+    return (double)total / s->freq;
+}
@@ -0,0 +1,40 @@
+/* stats.h - Timing where the time goes
+ *
+ * A stopwatch with laps. Every lap adds the time since the last one to a
+ * phase, so marking the end of each part of a loop splits up all of the
+ * time the loop took without anything falling through the gaps. Reading
+ * the performance counter is cheap enough to do this every frame.
+*/
+
+#ifndef STATS_H
+#define STATS_H
+
+#include <stdint.h>
+
+// Most phases one stopwatch can split time into
+#define STATS_PHASES 8
+
+typedef struct
+{
+    uint64_t freq;
+
+    // When the last lap ended
+    uint64_t mark;
+
+    // Performance counter ticks spent in each phase since stats_start()
+    uint64_t ticks[STATS_PHASES];
+} stats;
+
+// Zero every phase and start timing from now
+void stats_start(stats* s);
+
+// Add the time since the last lap (or stats_start()) to phase
+void stats_lap(stats* s, int phase);
+
+// Time spent in phase since stats_start(), in milliseconds
+double stats_ms(const stats* s, int phase);
+
+// Time since stats_start() in all phases together, in seconds
+double stats_seconds(const stats* s);
+
+#endif
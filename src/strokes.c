@@ -0,0 +1,211 @@
+/* strokes.c - Drawing cells with the mouse
+*/
+
+#include <SDL2/SDL.h>
+#include <stdlib.h>
+#include "strokes.h"
+
+typedef struct
+{
+    int x0, y0;
+    int x1, y1;
+    uint8_t alive;
+} stroke_line;
+
+struct strokes
+{
+    stroke_line lines[STROKES_SIZE];
+
+    // How many lines were ever put in and taken out. Only the main thread
+    // writes added and only the one drawing them writes taken, and a line
+    // is written before added counts it.
+    SDL_atomic_t added;
+    SDL_atomic_t taken;
+
+    // Everything from here on is only touched by the main thread. The line
+    // from (x, y) to (to_x, to_y) hasn't been queued yet if waiting is set.
+    int drawing;
+    uint8_t alive;
+    int x, y;
+    int to_x, to_y;
+    int waiting;
+    int queued;
+
+    // A stroke that started while that line was still waiting, which takes
+    // its place once it's queued. The mouse moves its end until then.
+    stroke_line next;
+    int next_waiting;
+};
+
+strokes* strokes_create(void)
+{
+    return calloc(1, sizeof(strokes));
+}
+
+void strokes_destroy(strokes* s)
+{
+    free(s);
+}
+
+// Queue the line that's waiting, and then the stroke waiting after it, for
+// as long as there's room
+static void push(strokes* s)
+{
+    while (s->waiting)
+    {
+        int added = SDL_AtomicGet(&s->added);
+
+        if ((unsigned int)added - (unsigned int)SDL_AtomicGet(&s->taken) >= STROKES_SIZE)
+            return;
+
+        // The drawing thread is done with the slot once taken says so, but
+        // its reads of it could still be on their way without this
+        SDL_MemoryBarrierAcquire();
+
+        stroke_line* line = &s->lines[(unsigned int)added % STROKES_SIZE];
+        line->x0 = s->x;
+        line->y0 = s->y;
+        line->x1 = s->to_x;
+        line->y1 = s->to_y;
+        line->alive = s->alive;
+
+        // Make sure the line is all there before added counts it
+        SDL_MemoryBarrierRelease();
+        SDL_AtomicSet(&s->added, (int)((unsigned int)added + 1));
+
+        // The next line starts where this one ended
+        s->x = s->to_x;
+        s->y = s->to_y;
+        s->waiting = 0;
+        s->queued = 1;
+
+        if (s->next_waiting)
+        {
+            s->alive = s->next.alive;
+            s->x = s->next.x0;
+            s->y = s->next.y0;
+            s->to_x = s->next.x1;
+            s->to_y = s->next.y1;
+            s->waiting = 1;
+            s->next_waiting = 0;
+        }
+    }
+}
+
+void strokes_begin(strokes* s, int x, int y, uint8_t alive)
+{
+    // A stroke that still didn't fit gets one last try
+    push(s);
+
+    s->drawing = 1;
+
+    // Still no room, so this one waits until the last one is queued. If an
+    // earlier one was already waiting to start, it never made it past its
+    // first line, and this takes its place.
+    if (s->waiting)
+    {
+        s->next.x0 = s->next.x1 = x;
+        s->next.y0 = s->next.y1 = y;
+        s->next.alive = alive;
+        s->next_waiting = 1;
+        return;
+    }
+
+    s->alive = alive;
+    s->x = s->to_x = x;
+    s->y = s->to_y = y;
+    s->waiting = 1;
+
+    push(s);
+}
+
+void strokes_move(strokes* s, int x, int y)
+{
+    if (!s->drawing)
+        return;
+
+    if (s->next_waiting)
+    {
+        s->next.x1 = x;
+        s->next.y1 = y;
+        push(s);
+        return;
+    }
+
+    if (x == s->to_x && y == s->to_y)
+        return;
+
+    s->to_x = x;
+    s->to_y = y;
+    s->waiting = 1;
+
+    push(s);
+}
+
+void strokes_end(strokes* s)
+{
+    s->drawing = 0;
+}
+
+int strokes_flush(strokes* s)
+{
+    push(s);
+
+    int queued = s->queued;
+    s->queued = 0;
+
+    return queued;
+}
+
+// Every cell on the line from (x0, y0) to (x1, y1) that's inside the grid
+static void draw_line(engine* sim, const stroke_line* line)
+{
+    int x = line->x0, y = line->y0;
+    int dx = abs(line->x1 - x), dy = -abs(line->y1 - y);
+    int sx = x < line->x1 ? 1 : -1, sy = y < line->y1 ? 1 : -1;
+    int error = dx + dy;
+
+    while (1)
+    {
+        if (x >= 0 && x < sim->width && y >= 0 && y < sim->height)
+            sim->set_cell(sim, x, y, line->alive);
+
+        if (x == line->x1 && y == line->y1)
+            break;
+
+        int twice = 2 * error;
+
+        if (twice >= dy)
+        {
+            error += dy;
+            x += sx;
+        }
+        if (twice <= dx)
+        {
+            error += dx;
+            y += sy;
+        }
+    }
+}
+
+int strokes_apply(strokes* s, engine* sim)
+{
+    unsigned int taken = (unsigned int)SDL_AtomicGet(&s->taken);
+    unsigned int added = (unsigned int)SDL_AtomicGet(&s->added);
+    int count = 0;
+
+    // Everything written into the lines before added got there is there
+    SDL_MemoryBarrierAcquire();
+
+    for (; taken != added; taken++, count++)
+    {
+        draw_line(sim, &s->lines[taken % STROKES_SIZE]);
+
+        // The main thread can have the slot once this is out, and not
+        // before the line was read
+        SDL_MemoryBarrierRelease();
+        SDL_AtomicSet(&s->taken, (int)(taken + 1));
+    }
+
+    return count;
+}
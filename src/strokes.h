@@ -0,0 +1,51 @@
+/* strokes.h - Drawing cells with the mouse
+ *
+ * Instead of setting the cell under the mouse once a frame, every mouse
+ * event that comes in while a button is down turns into a line from where
+ * the mouse was at the last one, so moving it fast draws a line instead of
+ * a few dots. The lines go into a queue, and whoever is stepping the engine
+ * draws them into it between generations: the main thread while paused or
+ * without --pipeline, the simulation thread while it's running with it.
+ * That way drawing works while the simulation runs, and nothing touches the
+ * engine while a generation is being stepped on the worker threads.
+ *
+ * The queue is a ring buffer with one thread putting lines in and one
+ * taking them out, which only ever wait for each other through two atomic
+ * counters. If it fills up, the line that didn't fit gets longer until
+ * there's room for it, so the stroke loses its corners but never gets gaps.
+ * A new stroke started while that line is still waiting waits behind it.
+*/
+
+#ifndef STROKES_H
+#define STROKES_H
+
+#include <stdint.h>
+#include "engine.h"
+
+// Lines the queue can hold
+#define STROKES_SIZE 4096
+
+typedef struct strokes strokes;
+
+strokes* strokes_create(void);
+void strokes_destroy(strokes* s);
+
+// Only the main thread, with cells that can be past the edges of the grid:
+// start a stroke at (x, y) that makes cells alive or dead, and follow the
+// mouse to (x, y)
+void strokes_begin(strokes* s, int x, int y, uint8_t alive);
+void strokes_move(strokes* s, int x, int y);
+
+// Also main thread only, the mouse button came up. Anything that didn't fit
+// into the queue still gets drawn.
+void strokes_end(strokes* s);
+
+// Main thread, once a frame. Queues up what didn't fit before, and returns
+// 1 if anything was queued since the last call.
+int strokes_flush(strokes* s);
+
+// Whoever has the engine at the time: draw every line in the queue into
+// sim. Returns how many lines were drawn.
+int strokes_apply(strokes* s, engine* sim);
+
+#endif
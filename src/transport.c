@@ -0,0 +1,295 @@
+/* transport.c - Sending messages between ranks
+*/
+
+#include <SDL2/SDL.h>
+#include <stdlib.h>
+#include <string.h>
+#include "transport.h"
+
+#ifdef GOL_MPI
+#include <mpi.h>
+#endif
+
+// A message that's been sent but not received yet
+typedef struct message
+{
+    struct message* next;
+    size_t size;
+    uint8_t data[];
+} message;
+
+// Everything the local ranks share. There's a queue for every pair of
+// ranks, queue (to * ranks + from) being the messages from from to to.
+typedef struct
+{
+    SDL_mutex* lock;
+    SDL_cond* arrived;
+
+    int ranks;
+    message** first;
+    message** last;
+
+    // Ranks not destroyed yet, the last one frees all of this
+    int open;
+} local_queues;
+
+typedef struct
+{
+    transport base;
+    local_queues* queues;
+} local_transport;
+
+static void local_queues_free(local_queues* q)
+{
+    for (int i = 0; q->first && i < q->ranks * q->ranks; i++)
+    {
+        while (q->first[i])
+        {
+            message* m = q->first[i];
+            q->first[i] = m->next;
+            free(m);
+        }
+    }
+
+    if (q->arrived)
+        SDL_DestroyCond(q->arrived);
+    if (q->lock)
+        SDL_DestroyMutex(q->lock);
+
+    free(q->first);
+    free(q->last);
+    free(q);
+}
+
+// Sending never waits here, the message is copied and the copy is queued
+static int local_send(transport* t, int to, const void* data, size_t size)
+{
+    local_queues* q = ((local_transport*)t)->queues;
+
+    message* m = malloc(sizeof(message) + size);
+    if (!m)
+        return 0;
+
+    m->next = NULL;
+    m->size = size;
+    memcpy(m->data, data, size);
+
+    int i = to * q->ranks + t->rank;
+
+    SDL_LockMutex(q->lock);
+
+    if (q->last[i])
+        q->last[i]->next = m;
+    else
+        q->first[i] = m;
+
+    q->last[i] = m;
+
+    SDL_CondBroadcast(q->arrived);
+    SDL_UnlockMutex(q->lock);
+
+    return 1;
+}
+
+static int local_recv(transport* t, int from, void* data, size_t size)
+{
+    local_queues* q = ((local_transport*)t)->queues;
+    int i = t->rank * q->ranks + from;
+
+    SDL_LockMutex(q->lock);
+
+    while (!q->first[i])
+        SDL_CondWait(q->arrived, q->lock);
+
+    message* m = q->first[i];
+    q->first[i] = m->next;
+
+    if (!q->first[i])
+        q->last[i] = NULL;
+
+    SDL_UnlockMutex(q->lock);
+
+    int ok = m->size == size;
+
+    if (ok)
+        memcpy(data, m->data, size);
+
+    free(m);
+    return ok;
+}
+
+static int local_exchange(transport* t, int to, const void* out, size_t out_size, int from, void* in, size_t in_size)
+{
+    int ok = 1;
+
+    if (to >= 0)
+        ok = local_send(t, to, out, out_size);
+    if (ok && from >= 0)
+        ok = local_recv(t, from, in, in_size);
+
+    return ok;
+}
+
+static void local_destroy(transport* t)
+{
+    local_queues* q = ((local_transport*)t)->queues;
+
+    SDL_LockMutex(q->lock);
+    int last = --q->open == 0;
+    SDL_UnlockMutex(q->lock);
+
+    if (last)
+        local_queues_free(q);
+
+    free(t);
+}
+
+transport** transport_create_local(int ranks)
+{
+    local_queues* q = calloc(1, sizeof(local_queues));
+    transport** all = calloc(ranks, sizeof(transport*));
+
+    if (!q || !all)
+    {
+        free(q);
+        free(all);
+        return NULL;
+    }
+
+    q->ranks = ranks;
+    q->first = calloc((size_t)ranks * ranks, sizeof(message*));
+    q->last = calloc((size_t)ranks * ranks, sizeof(message*));
+    q->lock = SDL_CreateMutex();
+    q->arrived = SDL_CreateCond();
+
+    int ok = q->first && q->last && q->lock && q->arrived;
+
+    for (int i = 0; ok && i < ranks; i++)
+    {
+        local_transport* l = calloc(1, sizeof(local_transport));
+        ok = l != NULL;
+
+        if (!ok)
+            break;
+
+        l->base.rank = i;
+        l->base.ranks = ranks;
+        l->base.send = local_send;
+        l->base.recv = local_recv;
+        l->base.exchange = local_exchange;
+        l->base.destroy = local_destroy;
+        l->queues = q;
+
+        all[i] = &l->base;
+        q->open++;
+    }
+
+    if (!ok)
+    {
+        for (int i = 0; i < ranks; i++)
+        {
+            free(all[i]);
+        }
+
+        local_queues_free(q);
+        free(all);
+        return NULL;
+    }
+
+    return all;
+}
+
+#ifdef GOL_MPI
+
+// Everything stays below 2 GB a message, which is as big as an int count
+// of bytes goes
+static int mpi_send(transport* t, int to, const void* data, size_t size)
+{
+    (void)t;
+    return MPI_Send(data, (int)size, MPI_BYTE, to, 0, MPI_COMM_WORLD) == MPI_SUCCESS;
+}
+
+static int mpi_recv(transport* t, int from, void* data, size_t size)
+{
+    (void)t;
+    MPI_Status status;
+    int count;
+
+    if (MPI_Recv(data, (int)size, MPI_BYTE, from, 0, MPI_COMM_WORLD, &status) != MPI_SUCCESS)
+        return 0;
+
+    return MPI_Get_count(&status, MPI_BYTE, &count) == MPI_SUCCESS && (size_t)count == size;
+}
+
+static int mpi_exchange(transport* t, int to, const void* out, size_t out_size, int from, void* in, size_t in_size)
+{
+    (void)t;
+    MPI_Status status;
+    int count;
+
+    if (MPI_Sendrecv(out, (int)out_size, MPI_BYTE, to < 0 ? MPI_PROC_NULL : to, 0,
+            in, (int)in_size, MPI_BYTE, from < 0 ? MPI_PROC_NULL : from, 0, MPI_COMM_WORLD, &status) != MPI_SUCCESS)
+        return 0;
+
+    return from < 0 || (MPI_Get_count(&status, MPI_BYTE, &count) == MPI_SUCCESS && (size_t)count == in_size);
+}
+
+static void mpi_destroy(transport* t)
+{
+    MPI_Finalize();
+    free(t);
+}
+
+transport* transport_create_mpi(void)
+{
+    transport* t = calloc(1, sizeof(transport));
+    if (!t)
+        return NULL;
+
+    if (MPI_Init(NULL, NULL) != MPI_SUCCESS)
+    {
+        free(t);
+        return NULL;
+    }
+
+    MPI_Comm_rank(MPI_COMM_WORLD, &t->rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &t->ranks);
+
+    t->send = mpi_send;
+    t->recv = mpi_recv;
+    t->exchange = mpi_exchange;
+    t->destroy = mpi_destroy;
+
+    return t;
+}
+
+#endif
+
+// Everyone sends theirs to rank 0, which sends the total back
+uint64_t transport_sum(transport* t, uint64_t value)
+{
+    int ok = 1;
+
+    if (t->rank != 0)
+    {
+        ok = t->send(t, 0, &value, sizeof(value)) && t->recv(t, 0, &value, sizeof(value));
+        return ok ? value : UINT64_MAX;
+    }
+
+    for (int i = 1; i < t->ranks; i++)
+    {
+        uint64_t theirs = 0;
+        ok = t->recv(t, i, &theirs, sizeof(theirs)) && ok;
+        value += theirs;
+    }
+
+    if (!ok)
+        value = UINT64_MAX;
+
+    for (int i = 1; i < t->ranks; i++)
+    {
+        t->send(t, i, &value, sizeof(value));
+    }
+
+    return value;
+}
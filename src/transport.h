@@ -0,0 +1,66 @@
+/* transport.h - Sending messages between ranks
+ *
+ * When a grid gets split up with --ranks or --mpi (see distrib.h), every
+ * piece is stepped by its own rank, and the ranks only ever talk to each
+ * other through this. A message is just some bytes from one rank to
+ * another, and messages between the same two ranks always arrive in the
+ * order they were sent.
+ *
+ * There are two ways of getting them there:
+ *
+ *  - local: every rank is a thread of this process, and messages are copies
+ *    in memory handed over in a queue. Works everywhere, and is how the
+ *    splitting gets checked against running on one engine.
+ *  - mpi: every rank is its own process started by mpirun, possibly on
+ *    different machines. Only there when built with GOL_MPI (make mpi).
+*/
+
+#ifndef TRANSPORT_H
+#define TRANSPORT_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+typedef struct transport transport;
+
+struct transport
+{
+    // Which rank this is, from 0 to ranks - 1
+    int rank;
+    int ranks;
+
+    // Send size bytes to rank to, returns 0 if it couldn't be sent. Can wait
+    // for the other side to receive it, so two ranks sending big messages to
+    // each other at the same time can get stuck, use exchange for that.
+    int (*send)(transport* t, int to, const void* data, size_t size);
+
+    // Wait for a message from rank from, which has to be exactly size bytes.
+    // Returns 0 if it was some other size or couldn't be received.
+    int (*recv)(transport* t, int from, void* data, size_t size);
+
+    // Send to one rank and receive from another at the same time, which
+    // never gets stuck as long as every rank is doing the same. A rank of -1
+    // skips that side. Returns 0 if either side failed.
+    int (*exchange)(transport* t, int to, const void* out, size_t out_size, int from, void* in, size_t in_size);
+
+    // Done with this rank
+    void (*destroy)(transport* t);
+};
+
+// Make ranks ranks that are threads of this process, returns an array of
+// one for every thread (each of which gets destroyed on its own), or NULL
+// if out of memory
+transport** transport_create_local(int ranks);
+
+#ifdef GOL_MPI
+// Join the ranks started by mpirun, returns NULL if MPI wouldn't start.
+// Destroying it shuts MPI down.
+transport* transport_create_mpi(void);
+#endif
+
+// Add up value over every rank, every rank gets the total, or UINT64_MAX if
+// some message didn't make it. Doubles as waiting for every rank to get
+// this far.
+uint64_t transport_sum(transport* t, uint64_t value);
+
+#endif
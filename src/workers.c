@@ -0,0 +1,182 @@
+/* workers.c - Worker thread pool
+*/
+
+#include <SDL2/SDL.h>
+#include <stdlib.h>
+#include "workers.h"
+
+struct workers
+{
+    int count;
+    SDL_Thread** threads;
+
+    SDL_mutex* lock;
+
+    // Signalled when a new job is posted, or when it is time to quit
+    SDL_cond* start;
+
+    // Signalled when the last worker finishes its piece
+    SDL_cond* done;
+
+    // Goes up by one for every job, so workers can tell a new job was posted
+    unsigned int job_id;
+    int remaining;
+    int quit;
+
+    workers_job job;
+    void* ctx;
+};
+
+typedef struct
+{
+    workers* pool;
+    int index;
+} worker_start;
+
+static int worker_main(void* data)
+{
+    worker_start* start = data;
+    workers* pool = start->pool;
+    int index = start->index;
+    unsigned int seen = 0;
+
+    free(start);
+
+    SDL_LockMutex(pool->lock);
+
+    while (1)
+    {
+        while (pool->job_id == seen && !pool->quit)
+            SDL_CondWait(pool->start, pool->lock);
+
+        if (pool->quit)
+            break;
+
+        seen = pool->job_id;
+        workers_job job = pool->job;
+        void* ctx = pool->ctx;
+
+        SDL_UnlockMutex(pool->lock);
+        job(ctx, index, pool->count);
+        SDL_LockMutex(pool->lock);
+
+        if (--pool->remaining == 0)
+            SDL_CondSignal(pool->done);
+    }
+
+    SDL_UnlockMutex(pool->lock);
+    return 0;
+}
+
+workers* workers_create(int count)
+{
+    if (count <= 0)
+        count = SDL_GetCPUCount();
+    if (count <= 0)
+        count = 1;
+
+    workers* pool = calloc(1, sizeof(workers));
+    if (!pool)
+        return NULL;
+
+    pool->count = count;
+    pool->threads = calloc(count, sizeof(SDL_Thread*));
+    pool->lock = SDL_CreateMutex();
+    pool->start = SDL_CreateCond();
+    pool->done = SDL_CreateCond();
+
+    if (!pool->threads || !pool->lock || !pool->start || !pool->done)
+    {
+        pool->count = 0;
+        workers_destroy(pool);
+        return NULL;
+    }
+
+    // Thread 0 is whoever calls workers_run()
+    for (int i = 1; i < count; i++)
+    {
+        worker_start* start = malloc(sizeof(worker_start));
+        if (start)
+        {
+            start->pool = pool;
+            start->index = i;
+            pool->threads[i] = SDL_CreateThread(worker_main, "gol worker", start);
+        }
+
+        if (!pool->threads[i])
+        {
+            free(start);
+            pool->count = i;
+            workers_destroy(pool);
+            return NULL;
+        }
+    }
+
+    return pool;
+}
+
+void workers_destroy(workers* pool)
+{
+    if (!pool)
+        return;
+
+    if (pool->lock)
+    {
+        SDL_LockMutex(pool->lock);
+        pool->quit = 1;
+        SDL_CondBroadcast(pool->start);
+        SDL_UnlockMutex(pool->lock);
+    }
+
+    for (int i = 1; i < pool->count; i++)
+        SDL_WaitThread(pool->threads[i], NULL);
+
+    if (pool->done)
+        SDL_DestroyCond(pool->done);
+    if (pool->start)
+        SDL_DestroyCond(pool->start);
+    if (pool->lock)
+        SDL_DestroyMutex(pool->lock);
+
+    free(pool->threads);
+    free(pool);
+}
+
+int workers_count(const workers* pool)
+{
+    return pool->count;
+}
+
+void workers_run(workers* pool, workers_job job, void* ctx)
+{
+    if (pool->count == 1)
+    {
+        job(ctx, 0, 1);
+        return;
+    }
+
+    SDL_LockMutex(pool->lock);
+    pool->job = job;
+    pool->ctx = ctx;
+    pool->remaining = pool->count - 1;
+    pool->job_id++;
+    SDL_CondBroadcast(pool->start);
+    SDL_UnlockMutex(pool->lock);
+
+    job(ctx, 0, pool->count);
+
+    SDL_LockMutex(pool->lock);
+    while (pool->remaining > 0)
+        SDL_CondWait(pool->done, pool->lock);
+    SDL_UnlockMutex(pool->lock);
+}
+
+void workers_band(int total, int index, int count, int* start, int* end)
+{
+    // Spread the leftover rows over the first few bands
+    int size = total / count;
+    int extra = total % count;
+
+    *start = index * size + (index < extra ? index : extra);
+    *end = *start + size + (index < extra ? 1 : 0);
+}
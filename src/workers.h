@@ -0,0 +1,31 @@
+/* workers.h - Worker thread pool
+ *
+ * A set of threads that stay around for the whole run, so a generation can
+ * be split between them without creating threads every step. A job is split
+ * into count pieces, and workers_run() only returns once every piece is done.
+ * The thread calling workers_run() does piece 0 itself.
+*/
+
+#ifndef WORKERS_H
+#define WORKERS_H
+
+typedef struct workers workers;
+
+// Does piece index out of count pieces of a job
+typedef void (*workers_job)(void* ctx, int index, int count);
+
+// Start a pool that splits work count ways, count - 1 new threads are made.
+// A count of 0 uses one thread per CPU core.
+workers* workers_create(int count);
+void workers_destroy(workers* pool);
+
+// How many pieces every job gets split into
+int workers_count(const workers* pool);
+
+// Run job on every thread in the pool and wait for all of them to finish
+void workers_run(workers* pool, workers_job job, void* ctx);
+
+// Split total rows into count bands, and get the rows [start, end) of one of them
+void workers_band(int total, int index, int count, int* start, int* end);
+
+#endif